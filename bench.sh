@@ -0,0 +1,214 @@
+#!/bin/sh
+# bench.sh - performance benchmark for spellingBee.exe
+#
+# Generates deterministic synthetic dictionaries, times each phase through the
+# solver's --stats=json report and writes one JSON result per (size, metric).
+# When a baseline exists the results are compared against it and the script
+# exits nonzero if any metric got slower than the allowed threshold.
+#
+# usage: ./bench.sh [options]
+#   -b <exe>        binary to benchmark (default ./spellingBee.exe)
+#   -n "<sizes>"    dictionary sizes in words (default "1000 100000 1000000",
+#                   the largest supported is 10000000)
+#   -l <letters>    letter distribution: every letter is drawn with a weight
+#                   equal to how often it appears in this string
+#                   (default roughly English frequencies)
+#   -r <reps>       repetitions per measurement, the fastest one counts (default 3)
+#   -o <file>       results file (default bench_results.json)
+#   -c <file>       baseline file (default bench_baseline.json)
+#   -t <percent>    allowed slowdown against the baseline (default 15)
+#   -s              save the results as the new baseline instead of comparing
+
+EXE=./spellingBee.exe
+SIZES="1000 100000 1000000"
+LETTERS="eeeeeeeeeeeetttttttttaaaaaaaaooooooooiiiiiiinnnnnnnsssssshhhhhhrrrrrrddddllllcccuuummwwffggyyppbbvkjxqz"
+REPS=3
+RESULTS=bench_results.json
+BASELINE=bench_baseline.json
+THRESHOLD=15
+SAVE=0
+DATA_DIR=bench_data
+
+# timings below this many seconds are noise and never count as regressions
+NOISE_FLOOR=0.005
+
+# fixed hives for the solver metrics ("hive reqLetter"), and seeds for -r
+HIVES="etaoins_e abcdefg_a rstlnea_r qzxjkvb_q hmpcodu_o"
+SEEDS="1 2 3"
+
+while getopts "b:n:l:r:o:c:t:s" opt; do
+    case $opt in
+        b) EXE=$OPTARG ;;
+        n) SIZES=$OPTARG ;;
+        l) LETTERS=$OPTARG ;;
+        r) REPS=$OPTARG ;;
+        o) RESULTS=$OPTARG ;;
+        c) BASELINE=$OPTARG ;;
+        t) THRESHOLD=$OPTARG ;;
+        s) SAVE=1 ;;
+        *) sed -n '9,20p' "$0"; exit 2 ;;
+    esac
+done
+
+if [ ! -x "$EXE" ]; then
+    echo "bench: $EXE not found (run make build first)"
+    exit 2
+fi
+mkdir -p "$DATA_DIR"
+
+# generateDictionary size file: fixed-seed random words of 4..12 letters drawn
+# from $LETTERS, sorted and deduplicated (so a few collisions may be dropped)
+generateDictionary() {
+    awk -v n="$1" -v letters="$LETTERS" 'BEGIN {
+        srand(211)
+        numLetters = length(letters)
+        for (i = 0; i < n; i++) {
+            # lengths 4..12, weighted towards 5..8 like real word lists
+            len = 4 + int(rand() * 4) + int(rand() * 3) + int(rand() * 3)
+            word = ""
+            for (k = 0; k < len; k++) {
+                word = word substr(letters, 1 + int(rand() * numLetters), 1)
+            }
+            print word
+        }
+    }' | LC_ALL=C sort -u > "$2"
+}
+
+# phaseTime json phase: wall seconds of one phase from a --stats=json line
+phaseTime() {
+    echo "$1" | sed -n "s/.*\"$2\":{\"wall_s\":\([0-9.]*\).*/\1/p"
+}
+
+# runSolver dict input args...: last line of the solver output (the stats)
+runSolver() {
+    dict=$1
+    input=$2
+    shift 2
+    printf "%s\n" "$input" | "$EXE" -d "$dict" --stats=json "$@" | tail -n 1
+}
+
+# minOf a b: smaller of two decimal numbers ("" counts as infinity)
+minOf() {
+    if [ -z "$1" ]; then
+        echo "$2"
+    else
+        awk -v a="$1" -v b="$2" 'BEGIN { print (b < a) ? b : a }'
+    fi
+}
+
+# addTo a b: a + b
+addTo() {
+    awk -v a="$1" -v b="$2" 'BEGIN { printf "%.6f\n", a + b }'
+}
+
+echo "[" > "$RESULTS"
+first=1
+
+# record size words metric seconds
+record() {
+    if [ $first -eq 0 ]; then
+        echo "," >> "$RESULTS"
+    fi
+    first=0
+    printf '  {"size": %s, "words": %s, "metric": "%s", "seconds": %s}' "$1" "$2" "$3" "$4" >> "$RESULTS"
+    printf "  %-9s %-12s %12s s\n" "$1" "$3" "$4"
+}
+
+for size in $SIZES; do
+    dict="$DATA_DIR/synthetic_$size.txt"
+    if [ ! -f "$dict" ]; then
+        echo "generating $dict..."
+        generateDictionary "$size" "$dict"
+    fi
+    words=$(wc -l < "$dict" | tr -d ' ')
+
+    load=""
+    brute=""
+    opt=""
+    walk=""
+    random=""
+    aggregate=""
+    rep=0
+    while [ $rep -lt "$REPS" ]; do
+        repLoad=""
+        repBrute=0
+        repOpt=0
+        repWalk=0
+        repRandom=0
+        repAggregate=0
+        for h in $HIVES; do
+            input=$(echo "$h" | tr '_' ' ')
+            stats=$(runSolver "$dict" "$input")
+            repLoad=$(minOf "$repLoad" "$(phaseTime "$stats" dictionary)")
+            repBrute=$(addTo "$repBrute" "$(phaseTime "$stats" solve)")
+            repAggregate=$(addTo "$repAggregate" "$(phaseTime "$stats" aggregate)")
+            stats=$(runSolver "$dict" "$input" -o)
+            repOpt=$(addTo "$repOpt" "$(phaseTime "$stats" solve)")
+            stats=$(runSolver "$dict" "$input" -a)
+            repWalk=$(addTo "$repWalk" "$(phaseTime "$stats" solve)")
+        done
+        for seed in $SEEDS; do
+            stats=$(runSolver "$dict" "" -r 7 -s "$seed")
+            repRandom=$(addTo "$repRandom" "$(phaseTime "$stats" hive)")
+        done
+        load=$(minOf "$load" "$repLoad")
+        brute=$(minOf "$brute" "$repBrute")
+        opt=$(minOf "$opt" "$repOpt")
+        walk=$(minOf "$walk" "$repWalk")
+        random=$(minOf "$random" "$repRandom")
+        aggregate=$(minOf "$aggregate" "$repAggregate")
+        rep=$((rep + 1))
+    done
+
+    record "$size" "$words" load "$load"
+    record "$size" "$words" brute_solve "$brute"
+    record "$size" "$words" opt_solve "$opt"
+    record "$size" "$words" walk_solve "$walk"
+    record "$size" "$words" random_hive "$random"
+    record "$size" "$words" aggregate "$aggregate"
+done
+printf "\n]\n" >> "$RESULTS"
+echo "results written to $RESULTS"
+
+if [ $SAVE -eq 1 ]; then
+    cp "$RESULTS" "$BASELINE"
+    echo "baseline saved to $BASELINE"
+    exit 0
+fi
+if [ ! -f "$BASELINE" ]; then
+    echo "no baseline at $BASELINE (run with -s to record one)"
+    exit 0
+fi
+
+# compare every result against the baseline entry with the same size and metric
+awk -v threshold="$THRESHOLD" -v floor="$NOISE_FLOOR" '
+    function field(line, name) {
+        if (match(line, "\"" name "\": \"?[^,}\"]*")) {
+            value = substr(line, RSTART, RLENGTH)
+            sub(/^"[a-z]*": "?/, "", value)
+            return value
+        }
+        return ""
+    }
+    /"metric"/ {
+        key = field($0, "size") "/" field($0, "metric")
+        if (FILENAME == ARGV[1]) {
+            base[key] = field($0, "seconds") + 0
+            next
+        }
+        if (!(key in base)) {
+            next
+        }
+        now = field($0, "seconds") + 0
+        limit = base[key] * (1 + threshold / 100)
+        if (now > limit && now > floor) {
+            printf "  REGRESSION %s: %.6f s vs baseline %.6f s\n", key, now, base[key]
+            failed = 1
+        }
+    }
+    END {
+        if (failed) {
+            exit 1
+        }
+        print "  no regressions beyond " threshold "%"
+    }' "$BASELINE" "$RESULTS"
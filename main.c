@@ -14,19 +14,421 @@ Author: Eldin Nokic
 #include <ctype.h>
 #include <stdbool.h>
 #include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdarg.h>
+#include <signal.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/file.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // constants for the game
 const int MIN_HIVE_SIZE = 2;
 const int MAX_HIVE_SIZE = 12;
 const int MIN_WORD_LENGTH = 4;
+const int MAX_HIVE_ATTEMPTS = 10000; // random hive redraws before giving up on constraints
+
+// words per brute-force chunk (64 KB of masks, stays in L2)
+#define SOLVE_CHUNK_WORDS 16384
+
+// bit set in a letter mask when the word has a character outside a-z,
+// so it can never be a subset of any hive
+#define NON_LETTER_BIT (1u << 26)
+
+// offset used for words that are not stored in the list's own pool
+#define NOT_IN_POOL ((size_t)-1)
+
+// --stats: phases of main, timed wall + CPU
+#define PHASE_SETTINGS 0
+#define PHASE_DICTIONARY 1
+#define PHASE_HIVE 2 // hive setup (random pick or user entry)
+#define PHASE_PLAY 3
+#define PHASE_SOLVE 4 // solver, or the whole -c/-b/-e tool run
+#define PHASE_AGGREGATE 5
+#define PHASE_OUTPUT 6
+#define NUM_PHASES 7
+
+#define STATS_OFF 0
+#define STATS_TEXT 1
+#define STATS_JSON 2 // one JSON object on a single line
+
+// run-wide timers and hot-path counters; the counters are only touched when
+// --stats is on and are atomic because batch and -j workers share them
+typedef struct RunStats_struct {
+    bool enabled;
+    int phase; // phase being timed now
+    double phaseWallStart;
+    double phaseCpuStart;
+    double wall[NUM_PHASES]; // seconds per phase
+    double cpu[NUM_PHASES];
+    atomic_llong walkFrames; // prefixes the -a walk visited
+    atomic_int walkMaxDepth; // longest prefix of a single walk
+    atomic_llong appendWordCalls; // appendWord, appendWordView and appendWordRef
+    atomic_llong bytesAllocated; // word list columns, string pools and hash sets
+    atomic_llong wordsScanned; // candidates examined by the solvers
+    atomic_llong cacheHits; // --cache lookups answered from memory or the file
+    atomic_llong cacheMisses;
+} RunStats;
+
+RunStats runStats;
+
+/*
+purpose: read a clock in seconds
+parameters: clockId (CLOCK_MONOTONIC for wall, CLOCK_PROCESS_CPUTIME_ID for CPU)
+returns: seconds
+*/
+double readClock(clockid_t clockId) {
+    struct timespec ts;
+    clock_gettime(clockId, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+purpose: close the phase being timed and start timing another
+parameters: phase (PHASE_*)
+returns: nothing
+*/
+void enterPhase(int phase) {
+    double wallNow = readClock(CLOCK_MONOTONIC);
+    double cpuNow = readClock(CLOCK_PROCESS_CPUTIME_ID);
+    runStats.wall[runStats.phase] += wallNow - runStats.phaseWallStart;
+    runStats.cpu[runStats.phase] += cpuNow - runStats.phaseCpuStart;
+    runStats.phase = phase;
+    runStats.phaseWallStart = wallNow;
+    runStats.phaseCpuStart = cpuNow;
+}
+
+/*
+purpose: add to a --stats counter (no-op unless --stats is on)
+parameters: counter, amount
+returns: nothing
+*/
+void countStat(atomic_llong* counter, long long amount) {
+    if (runStats.enabled) {
+        atomic_fetch_add_explicit(counter, amount, memory_order_relaxed);
+    }
+}
+
+/*
+purpose: raise a --stats maximum to value if it is larger (no-op unless --stats is on)
+parameters: maximum, value
+returns: nothing
+*/
+void maxStat(atomic_int* maximum, int value) {
+    if (runStats.enabled) {
+        int current = atomic_load_explicit(maximum, memory_order_relaxed);
+        while (value > current && !atomic_compare_exchange_weak(maximum, &current, value)) {
+        }
+    }
+}
+
+/*
+purpose: print the --stats report: time per phase, counters and peak RSS
+parameters: format (STATS_TEXT or STATS_JSON)
+returns: nothing
+*/
+void printRunStats(int format) {
+    const char* phaseNames[NUM_PHASES] = {"settings", "dictionary", "hive", "play", "solve", "aggregate", "output"};
+    enterPhase(runStats.phase); // bank the time of the phase still running
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    long peakRssKb = usage.ru_maxrss; // kilobytes on Linux
+
+    long long walkFrames = atomic_load(&runStats.walkFrames);
+    int walkMaxDepth = atomic_load(&runStats.walkMaxDepth);
+    long long appendWordCalls = atomic_load(&runStats.appendWordCalls);
+    long long bytesAllocated = atomic_load(&runStats.bytesAllocated);
+    long long wordsScanned = atomic_load(&runStats.wordsScanned);
+    long long cacheHits = atomic_load(&runStats.cacheHits);
+    long long cacheMisses = atomic_load(&runStats.cacheMisses);
+
+    if (format == STATS_JSON) {
+        printf("{\"phases\":{");
+        for (int i = 0; i < NUM_PHASES; i++) {
+            printf("%s\"%s\":{\"wall_s\":%.6f,\"cpu_s\":%.6f}", (i == 0) ? "" : ",", phaseNames[i], runStats.wall[i], runStats.cpu[i]);
+        }
+        printf("},\"walk_frames\":%lld,\"walk_max_depth\":%d,\"append_word_calls\":%lld,", walkFrames, walkMaxDepth, appendWordCalls);
+        printf("\"bytes_allocated\":%lld,\"words_scanned\":%lld,\"cache_hits\":%lld,\"cache_misses\":%lld,\"peak_rss_kb\":%ld}\n",
+               bytesAllocated, wordsScanned, cacheHits, cacheMisses, peakRssKb);
+        return;
+    }
+
+    printf("==== RUN STATS ====\n");
+    printf("  %-12s %12s %12s\n", "phase", "wall (ms)", "cpu (ms)");
+    for (int i = 0; i < NUM_PHASES; i++) {
+        printf("  %-12s %12.3f %12.3f\n", phaseNames[i], runStats.wall[i] * 1000, runStats.cpu[i] * 1000);
+    }
+    printf("  walk frames: %lld (max depth %d)\n", walkFrames, walkMaxDepth);
+    printf("  appendWord calls: %lld\n", appendWordCalls);
+    printf("  bytes allocated: %lld\n", bytesAllocated);
+    printf("  words scanned: %lld\n", wordsScanned);
+    printf("  cache hits: %lld (misses %lld)\n", cacheHits, cacheMisses);
+    printf("  peak RSS: %ld KB\n", peakRssKb);
+}
+
+// --format: how results are written (the decorative text always stays text)
+#define FORMAT_TEXT 0
+#define FORMAT_JSONL 1 // one JSON object per line
+#define FORMAT_CSV 2 // header line, then one row per line
+
+#define OUTPUT_BUFFER_SIZE (1 << 16)
+
+// results writer: rows are formatted into one reusable buffer that goes to the
+// kernel with write() when it fills up, instead of one stdio call per cell
+typedef struct OutputWriter_struct {
+    char* text; // allocated on first use
+    int len;
+    int cap;
+    int fd; // where results go (stdout, or a dup of it for jsonl/csv)
+    int format; // FORMAT_*
+} OutputWriter;
+
+OutputWriter outWriter = {NULL, 0, 0, 1, FORMAT_TEXT};
+
+/*
+purpose: hand everything buffered to the kernel (stdio first, so text printed
+with printf before the buffered rows stays in front of them)
+parameters: none
+returns: nothing
+*/
+void outFlush() {
+    fflush(stdout);
+    int written = 0;
+    while (written < outWriter.len) {
+        ssize_t n = write(outWriter.fd, outWriter.text + written, outWriter.len - written);
+        if (n <= 0) {
+            break; // reader went away: drop the rest like stdio would
+        }
+        written += n;
+    }
+    outWriter.len = 0;
+}
+
+/*
+purpose: printf into the results buffer, flushing it when it is full
+parameters: format + arguments as for printf
+returns: nothing
+*/
+void outPrintf(const char* format, ...) {
+    if (outWriter.text == NULL) {
+        outWriter.cap = OUTPUT_BUFFER_SIZE;
+        outWriter.text = malloc(outWriter.cap);
+    }
+    while (true) {
+        va_list args;
+        va_start(args, format);
+        int needed = vsnprintf(outWriter.text + outWriter.len, outWriter.cap - outWriter.len, format, args);
+        va_end(args);
+        if (outWriter.len + needed < outWriter.cap) {
+            outWriter.len += needed;
+            return;
+        }
+        if (outWriter.len > 0) {
+            outFlush();
+        }
+        else {
+            // a single piece bigger than the buffer
+            outWriter.cap = needed + 1;
+            outWriter.text = realloc(outWriter.text, outWriter.cap);
+        }
+    }
+}
+
+/*
+purpose: make room for size more bytes in the results buffer, flushing it
+(or growing it, for a single piece bigger than the buffer) when needed
+parameters: size
+returns: nothing
+*/
+void outReserve(int size) {
+    if (outWriter.text == NULL) {
+        outWriter.cap = OUTPUT_BUFFER_SIZE;
+        outWriter.text = malloc(outWriter.cap);
+    }
+    if (outWriter.len + size <= outWriter.cap) {
+        return;
+    }
+    if (outWriter.len > 0) {
+        outFlush();
+    }
+    if (size > outWriter.cap) {
+        outWriter.cap = size;
+        outWriter.text = realloc(outWriter.text, outWriter.cap);
+    }
+}
+
+/*
+purpose: write a string as a JSON string or CSV field (quoted only when needed);
+dictionary words are any non-space characters, so they may need escaping
+parameters: str
+returns: nothing
+*/
+void outQuoted(const char* str) {
+    int length = strlen(str);
+    if (outWriter.format == FORMAT_CSV) {
+        bool quote = strpbrk(str, ",\"") != NULL;
+        outReserve(2 * length + 2); // every character doubled, plus the quotes
+        char* out = outWriter.text + outWriter.len;
+        if (quote) {
+            *out++ = '"';
+        }
+        for (int i = 0; i < length; i++) {
+            if (str[i] == '"') {
+                *out++ = '"';
+            }
+            *out++ = str[i];
+        }
+        if (quote) {
+            *out++ = '"';
+        }
+        outWriter.len = out - outWriter.text;
+        return;
+    }
+    outReserve(6 * length + 2); // every character as \u00XX, plus the quotes
+    char* out = outWriter.text + outWriter.len;
+    *out++ = '"';
+    for (int i = 0; i < length; i++) {
+        unsigned char c = str[i];
+        if (c == '"' || c == '\\') {
+            *out++ = '\\';
+            *out++ = c;
+        }
+        else if (c < 0x20) {
+            out += sprintf(out, "\\u%04x", c);
+        }
+        else {
+            *out++ = c;
+        }
+    }
+    *out++ = '"';
+    outWriter.len = out - outWriter.text;
+}
+
+/*
+purpose: release the results buffer (after a last flush)
+parameters: none
+returns: nothing
+*/
+void freeOutputWriter() {
+    outFlush();
+    free(outWriter.text);
+    outWriter.text = NULL;
+    outWriter.cap = 0;
+}
+
+// index from each distinct letter-set mask to the dictionary words using it
+typedef struct MaskIndex_struct {
+    unsigned int* masks; // distinct word masks, sorted ascending
+    int* starts; // bucket i is wordIds[starts[i]] ... wordIds[starts[i+1]-1]
+    int* wordIds; // dictionary indices, grouped by mask, ascending per bucket
+    int numMasks; // how many distinct masks (buckets) there are
+    bool mapped; // arrays live inside a compiled dictionary image (not freed)
+} MaskIndex;
+
+void freeMaskIndex(MaskIndex* index);
+
+// compact trie over the lower-case dictionary words: the children of a node
+// sit next to each other in BFS order, and childMask says which letters exist,
+// so the child for letter bit b is childStart + popcount(childMask & (b - 1))
+typedef struct TrieNode_struct {
+    int childStart; // node index of the first (lowest letter) child
+    unsigned int childMask; // letters that have a child
+    int wordId; // dictionary index of the word ending here, -1 if none
+} TrieNode;
+
+typedef struct Trie_struct {
+    TrieNode* nodes; // nodes[0] is the root (empty prefix)
+    int numNodes; // how many nodes are in use
+    bool mapped; // nodes live inside a compiled dictionary image (not freed)
+} Trie;
+
+void freeTrie(Trie* trie);
+
+typedef struct LengthBuckets_struct LengthBuckets;
+void freeLengthBuckets(LengthBuckets* buckets);
+
+typedef struct LetterBitmaps_struct LetterBitmaps;
+void freeLetterBitmaps(LetterBitmaps* bitmaps);
+
 
-// struct that is used to hold lists of words
 typedef struct WordList_struct {
     char** words; // stores an array of pointers to words
     int numWords; // how many words are in the list
     int capacity; // how much space we currenlty have 
+    unsigned int* masks; // parallel column: 26-bit letter mask of each word
+    size_t* offsets; // parallel column: where each word starts in pool (or NOT_IN_POOL)
+    int* lengths; // parallel column: strlen of each word
+    unsigned char* uniqueCounts; // parallel column: countUniqueLetters of each word
+    char* pool; // arena: all copied strings back to back, '\0' terminated
+    size_t poolUsed; // bytes of pool in use
+    size_t poolCap; // bytes of pool allocated
+    char* mapBase; // if not NULL, pool lives in this file mapping (munmap'd on free)
+    size_t mapLen; // size of the mapping
+    bool columnsMapped; // masks/offsets/lengths/uniqueCounts also point into the mapping
+    MaskIndex* maskIndex; // letter-set index, built on demand or loaded with the dictionary
+    Trie* trie; // -o solver's trie, built once at load or loaded with the dictionary
+    LengthBuckets* lengthBuckets; // word ids by length, built on demand by queries
+    LetterBitmaps* bitmaps; // -m solver's per-letter bitmaps, built once at load
+    int* setSlots; // open-addressing hash set of word positions + 1 (0 = empty), NULL until used
+    int setCap; // number of slots, a power of two
 } WordList;
 
+/*
+purpose: build the letter mask of a word (bit i set if letter 'a'+i appears,
+case-insensitive), with NON_LETTER_BIT set if any other character appears
+parameters: word
+returns: the mask
+*/
+unsigned int letterMask(char* word) {
+    unsigned int mask = 0;
+    for (int i = 0; word[i] != '\0'; i++) {
+        int c = tolower((unsigned char)word[i]);
+        if (c >= 'a' && c <= 'z') {
+            mask |= 1u << (c - 'a');
+        }
+        else {
+            mask |= NON_LETTER_BIT;
+        }
+    }
+    return mask;
+}
+
+/*
+purpose: count how many distinct lowercase letters are in str 
+parameters: str 
+returns: number of unique letters 0-26
+*/
+int countUniqueLetters(char* str) {
+    int already[26] = {0};
+    int count = 0;
+
+    for (int i = 0; str[i] != '\0'; i++){
+        if (str[i] >= 'a' && str[i] <= 'z') {
+            int index = str[i] - 'a';
+            if (already[index] == 0){
+                already[index] = 1;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
 /*
 purpose: make an empty dynamic list of words with some starter capacity
 parameters: none
@@ -37,54 +439,238 @@ WordList* createWordList() {
     newList->capacity = 4; // start with 4
     newList->numWords = 0; // no words yet
     newList->words = malloc(newList->capacity * sizeof(char*)); // allocate array of word pointers
+    newList->masks = malloc(newList->capacity * sizeof(unsigned int)); // and the matching masks
+    newList->offsets = malloc(newList->capacity * sizeof(size_t)); // and where they sit in the pool
+    newList->lengths = malloc(newList->capacity * sizeof(int)); // and how long they are
+    newList->uniqueCounts = malloc(newList->capacity * sizeof(unsigned char)); // and their letter counts
+    newList->pool = NULL; // string pool is allocated on the first copy
+    newList->poolUsed = 0;
+    newList->poolCap = 0;
+    newList->mapBase = NULL;
+    newList->mapLen = 0;
+    newList->columnsMapped = false;
+    newList->maskIndex = NULL;
+    newList->trie = NULL;
+    newList->lengthBuckets = NULL;
+    newList->bitmaps = NULL;
+    newList->setSlots = NULL; // hash set is created by the first unique append
+    newList->setCap = 0;
+    countStat(&runStats.bytesAllocated, sizeof(WordList) + newList->capacity * (sizeof(char*) + sizeof(unsigned int) + sizeof(size_t) + sizeof(int) + sizeof(unsigned char)));
 
     return newList;
 }
 
 /*
-purpose: append a copy of newWord to the end of the list, grow array if needed
+purpose: make room for one more word in the list columns (doubling, so the
+columns are reallocated O(log n) times in total)
+parameters: thisWordList
+returns: nothing (list is updated in place)
+*/
+void growWordList(WordList* thisWordList) {
+    if (thisWordList->numWords < thisWordList->capacity) {
+        return;
+    }
+    int newCap = thisWordList->capacity * 2;
+    thisWordList->words = realloc(thisWordList->words, newCap * sizeof(char*));
+    thisWordList->masks = realloc(thisWordList->masks, newCap * sizeof(unsigned int));
+    thisWordList->offsets = realloc(thisWordList->offsets, newCap * sizeof(size_t));
+    thisWordList->lengths = realloc(thisWordList->lengths, newCap * sizeof(int));
+    thisWordList->uniqueCounts = realloc(thisWordList->uniqueCounts, newCap * sizeof(unsigned char));
+    countStat(&runStats.bytesAllocated, (long long)(newCap - thisWordList->capacity) * (sizeof(char*) + sizeof(unsigned int) + sizeof(size_t) + sizeof(int) + sizeof(unsigned char)));
+    thisWordList->capacity = newCap;
+}
+
+/*
+purpose: 64-bit FNV-1a hash of a word, used by the WordList hash set
+parameters: word
+returns: the hash
+*/
+unsigned long long hashWord(char* word) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (int i = 0; word[i] != '\0'; i++) {
+        hash ^= (unsigned char)word[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*
+purpose: look a word up in the list's hash set (linear probing)
+parameters: thisWordList (set must exist), word
+returns: the slot holding the word, or the empty slot where it would go
+*/
+int findWordSlot(WordList* thisWordList, char* word) {
+    int mask = thisWordList->setCap - 1;
+    int slot = (int)(hashWord(word) & mask);
+    while (thisWordList->setSlots[slot] != 0) {
+        if (strcmp(thisWordList->words[thisWordList->setSlots[slot] - 1], word) == 0) {
+            return slot;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/*
+purpose: record word number pos in the hash set, rehashing into twice the
+slots once the set would be more than half full
+parameters: thisWordList (set must exist), pos (index of the word in the list)
+returns: nothing
+*/
+void wordSetInsert(WordList* thisWordList, int pos) {
+    if (2 * (pos + 1) > thisWordList->setCap) {
+        free(thisWordList->setSlots);
+        thisWordList->setCap *= 2;
+        thisWordList->setSlots = calloc(thisWordList->setCap, sizeof(int));
+        countStat(&runStats.bytesAllocated, thisWordList->setCap * sizeof(int));
+        for (int i = 0; i < pos; i++) {
+            thisWordList->setSlots[findWordSlot(thisWordList, thisWordList->words[i])] = i + 1;
+        }
+    }
+    thisWordList->setSlots[findWordSlot(thisWordList, thisWordList->words[pos])] = pos + 1;
+}
+
+/*
+purpose: O(1) lookup; the first call builds the hash set from the words
+already in the list, after which every append keeps it up to date
+parameters: thisWordList, word
+returns: index of (the first copy of) word in the list, -1 if it is not there
+*/
+int findWordIndex(WordList* thisWordList, char* word) {
+    if (thisWordList->setSlots == NULL) {
+        thisWordList->setCap = 16;
+        while (thisWordList->setCap < 2 * (thisWordList->numWords + 1)) {
+            thisWordList->setCap *= 2;
+        }
+        thisWordList->setSlots = calloc(thisWordList->setCap, sizeof(int));
+        countStat(&runStats.bytesAllocated, thisWordList->setCap * sizeof(int));
+        for (int i = 0; i < thisWordList->numWords; i++) {
+            thisWordList->setSlots[findWordSlot(thisWordList, thisWordList->words[i])] = i + 1;
+        }
+    }
+    return thisWordList->setSlots[findWordSlot(thisWordList, word)] - 1;
+}
+
+/*
+purpose: O(1) membership test (see findWordIndex)
+parameters: thisWordList, word
+returns: true if the list already holds word
+*/
+bool containsWord(WordList* thisWordList, char* word) {
+    return findWordIndex(thisWordList, word) != -1;
+}
+
+/*
+purpose: append a copy of newWord to the end of the list; the copy goes into
+the list's string pool, which doubles when full (not for mapped pools)
 parameters: thisWordList (list we add into), newWord (string to copy)
 returns: nothing (list is updates in place)
 */
 void appendWord(WordList* thisWordList, char* newWord) {
-    // grow the array when full 
-    if (thisWordList->numWords >= thisWordList->capacity) {
-
-        int newCap = thisWordList->capacity * 2;
-        char** newList = (char**)malloc(newCap * sizeof(char*));
+    countStat(&runStats.appendWordCalls, 1);
+    growWordList(thisWordList);
 
-        // copy existing pointers over
-        for (int i = 0; i < thisWordList->numWords; i++) {
-            newList[i] = thisWordList->words[i];
+    size_t length = strlen(newWord);
+    if (thisWordList->poolUsed + length + 1 > thisWordList->poolCap) {
+        size_t newCap = (thisWordList->poolCap == 0) ? 64 : thisWordList->poolCap * 2;
+        while (newCap < thisWordList->poolUsed + length + 1) {
+            newCap *= 2;
         }
+        char* oldPool = thisWordList->pool;
+        thisWordList->pool = realloc(thisWordList->pool, newCap);
+        countStat(&runStats.bytesAllocated, newCap - thisWordList->poolCap);
+        thisWordList->poolCap = newCap;
 
-        // swap and update capacity
-        free(thisWordList->words);
-        thisWordList->words = newList;
-        thisWordList->capacity = newCap;
+        // the pool may have moved: re-point the words we own
+        if (thisWordList->pool != oldPool) {
+            for (int i = 0; i < thisWordList->numWords; i++) {
+                if (thisWordList->offsets[i] != NOT_IN_POOL) {
+                    thisWordList->words[i] = thisWordList->pool + thisWordList->offsets[i];
+                }
+            }
+        }
     }
-    // store a fresh copy of the word 
-    int length = strlen(newWord);
-    char* copy = malloc((length + 1) * sizeof(char));
-    strcpy(copy, newWord);
+
+    // store a fresh copy of the word at the end of the pool
+    char* copy = thisWordList->pool + thisWordList->poolUsed;
+    memcpy(copy, newWord, length + 1);
 
     thisWordList->words[thisWordList->numWords] = copy;
+    thisWordList->masks[thisWordList->numWords] = letterMask(copy);
+    thisWordList->offsets[thisWordList->numWords] = thisWordList->poolUsed;
+    thisWordList->lengths[thisWordList->numWords] = (int)length;
+    thisWordList->uniqueCounts[thisWordList->numWords] = countUniqueLetters(copy);
+    thisWordList->poolUsed += length + 1;
     thisWordList->numWords += 1;
+    if (thisWordList->setSlots != NULL) {
+        wordSetInsert(thisWordList, thisWordList->numWords - 1);
+    }
 
 }
 
 /*
-purpose: read words from a file and add only words of length >= minLength
-parameters: filename (dictionary path), dictionaryList (output list), minLength
-returns: length of the longest word added, or -1 on error
+purpose: append a word that already sits '\0'-terminated in the list's pool
+(used by the mapped loader, nothing is copied)
+parameters: thisWordList, offset (start of the word in pool), length
+returns: nothing (list is updated in place)
 */
-int buildDictionary(char* filename, WordList* dictionaryList, int minLength) {
+void appendWordView(WordList* thisWordList, size_t offset, int length) {
+    countStat(&runStats.appendWordCalls, 1);
+    growWordList(thisWordList);
 
-    FILE* f = fopen(filename, "r");
-    if (f == NULL) {
-        return -1;
+    char* word = thisWordList->pool + offset;
+    thisWordList->words[thisWordList->numWords] = word;
+    thisWordList->masks[thisWordList->numWords] = letterMask(word);
+    thisWordList->offsets[thisWordList->numWords] = offset;
+    thisWordList->lengths[thisWordList->numWords] = length;
+    thisWordList->uniqueCounts[thisWordList->numWords] = countUniqueLetters(word);
+    thisWordList->numWords += 1;
+    if (thisWordList->setSlots != NULL) {
+        wordSetInsert(thisWordList, thisWordList->numWords - 1);
     }
-    
+}
+
+/*
+purpose: append word number index of sourceList without copying the string;
+sourceList must outlive this list and not grow while it is referenced
+parameters: thisWordList (list we add into), sourceList, index (into sourceList)
+returns: nothing (list is updated in place)
+*/
+void appendWordRef(WordList* thisWordList, WordList* sourceList, int index) {
+    countStat(&runStats.appendWordCalls, 1);
+    growWordList(thisWordList);
+
+    thisWordList->words[thisWordList->numWords] = sourceList->words[index];
+    thisWordList->masks[thisWordList->numWords] = sourceList->masks[index];
+    thisWordList->offsets[thisWordList->numWords] = NOT_IN_POOL;
+    thisWordList->lengths[thisWordList->numWords] = sourceList->lengths[index];
+    thisWordList->uniqueCounts[thisWordList->numWords] = sourceList->uniqueCounts[index];
+    thisWordList->numWords += 1;
+    if (thisWordList->setSlots != NULL) {
+        wordSetInsert(thisWordList, thisWordList->numWords - 1);
+    }
+}
+
+/*
+purpose: appendWordRef, but only if the list does not already hold that word
+parameters: thisWordList, sourceList, index (into sourceList)
+returns: true if the word was added, false if it was a duplicate
+*/
+bool appendUniqueRef(WordList* thisWordList, WordList* sourceList, int index) {
+    if (containsWord(thisWordList, sourceList->words[index])) {
+        return false;
+    }
+    appendWordRef(thisWordList, sourceList, index);
+    return true;
+}
+
+/*
+purpose: read words from a stream with fscanf and add only words of length >= minLength
+(fallback for pipes, stdin and anything that cannot be mapped)
+parameters: f (open stream), dictionaryList (output list), minLength
+returns: length of the longest word added, or -1 on error
+*/
+int buildDictionaryStream(FILE* f, WordList* dictionaryList, int minLength) {
     int added = 0;
     int longest = -1;
     char word[128];
@@ -101,7 +687,102 @@ int buildDictionary(char* filename, WordList* dictionaryList, int minLength) {
         }
     }
 
-    fclose(f);
+    if (added == 0) {
+        return -1;
+    }
+
+    return longest;
+}
+
+/*
+purpose: whitespace test matching fscanf's %s in the C locale
+parameters: c
+returns: true for ' ', '\t', '\n', '\v', '\f', '\r'
+*/
+bool isSpaceChar(char c) {
+    return c == ' ' || (unsigned char)(c - '\t') <= '\r' - '\t';
+}
+
+/*
+purpose: find the first whitespace byte at or after pos, 16 bytes at a time with SSE2
+parameters: text, pos (start), end (stop here if no whitespace is found)
+returns: index of the whitespace byte, or end
+*/
+size_t findNextSpace(char* text, size_t pos, size_t end) {
+#if defined(__SSE2__)
+    __m128i space = _mm_set1_epi8(' ');
+    __m128i tab = _mm_set1_epi8('\t');
+    __m128i range = _mm_set1_epi8('\r' - '\t');
+    __m128i zero = _mm_setzero_si128();
+    while (pos + 16 <= end) {
+        __m128i v = _mm_loadu_si128((__m128i*)(text + pos));
+        // (v - '\t') saturating-minus 4 is zero exactly for '\t'..'\r'
+        __m128i ctrl = _mm_cmpeq_epi8(_mm_subs_epu8(_mm_sub_epi8(v, tab), range), zero);
+        int hits = _mm_movemask_epi8(_mm_or_si128(ctrl, _mm_cmpeq_epi8(v, space)));
+        if (hits != 0) {
+            return pos + __builtin_ctz(hits);
+        }
+        pos += 16;
+    }
+#endif
+    while (pos < end && !isSpaceChar(text[pos])) {
+        pos++;
+    }
+    return pos;
+}
+
+/*
+purpose: load a regular file by mapping it privately and splitting it in place;
+each token is '\0'-terminated where its whitespace was and recorded as an
+(offset, length) view, so no word is copied. the mapping is one byte longer
+than the file so the last token always has a zero after it
+parameters: fd (open regular file), size (file size), dictionaryList (empty output list), minLength
+returns: length of the longest word added, -1 if no word qualified, -2 if mapping failed
+*/
+int buildDictionaryMapped(int fd, size_t size, WordList* dictionaryList, int minLength) {
+    size_t mapLen = size + 1;
+
+    // reserve zeroed space for file + terminator, then map the file over the front
+    char* base = mmap(NULL, mapLen, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        return -2;
+    }
+    if (mmap(base, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, mapLen);
+        return -2;
+    }
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    dictionaryList->pool = base;
+    dictionaryList->poolUsed = mapLen;
+    dictionaryList->poolCap = mapLen;
+    dictionaryList->mapBase = base;
+    dictionaryList->mapLen = mapLen;
+
+    int added = 0;
+    int longest = -1;
+    size_t pos = 0;
+
+    // one pass: skip whitespace, find token end, filter and track max length
+    while (pos < size) {
+        while (pos < size && isSpaceChar(base[pos])) {
+            pos++;
+        }
+        if (pos == size) {
+            break;
+        }
+        size_t end = findNextSpace(base, pos, size);
+        int length = (int)(end - pos);
+        base[end] = '\0';
+        if (length >= minLength) {
+            appendWordView(dictionaryList, pos, length);
+            added++;
+            if (length > longest) {
+                longest = length;
+            }
+        }
+        pos = end + 1;
+    }
 
     if (added == 0) {
         return -1;
@@ -111,7 +792,7 @@ int buildDictionary(char* filename, WordList* dictionaryList, int minLength) {
 }
 
 /*
-purpose: free all heap memory tied to a WordList (words + array + struct)
+purpose: free all heap memory tied to a WordList (pool + columns + struct)
 parameters: list 
 returns: nothing
 */
@@ -120,10 +801,26 @@ void freeWordList(WordList* list) {
         return;
     }
 
-    for (int i = 0; i < list->numWords; i++) {
-        free(list->words[i]);
+    freeMaskIndex(list->maskIndex);
+    freeTrie(list->trie);
+    freeLengthBuckets(list->lengthBuckets);
+    freeLetterBitmaps(list->bitmaps);
+
+    // every string we own lives in the pool, so one free covers them all
+    if (list->mapBase != NULL) {
+        munmap(list->mapBase, list->mapLen);
+    }
+    else {
+        free(list->pool);
+    }
+    if (!list->columnsMapped) {
+        free(list->masks);
+        free(list->offsets);
+        free(list->lengths);
+        free(list->uniqueCounts);
     }
     free(list->words);
+    free(list->setSlots);
     free(list);
 }
 
@@ -163,42 +860,63 @@ void buildHive(char* str, char* hive) {
     hive[count] = '\0';
 }
 
+// dictionary word indices grouped by number of unique letters (from the
+// uniqueCounts column), so random mode can pick a fit word without copying
+typedef struct UniqueBuckets_struct {
+    int starts[28]; // words with u unique letters are wordIds[starts[u]] ... wordIds[starts[u+1]-1]
+    int* wordIds; // dictionary indices, in dictionary order within each bucket
+} UniqueBuckets;
+
 /*
-purpose: count how many distinct lowercase letters are in str 
-parameters: str 
-returns: number of unique letters 0-26
+purpose: bucket the dictionary by unique letter count (counting sort, one pass)
+parameters: dictionaryList
+returns: pointer to a new UniqueBuckets on the heap
 */
-int countUniqueLetters(char* str) {
-    int already[26] = {0};
-    int count = 0;
-
-    for (int i = 0; str[i] != '\0'; i++){
-        if (str[i] >= 'a' && str[i] <= 'z') {
-            int index = str[i] - 'a';
-            if (already[index] == 0){
-                already[index] = 1;
-                count++;
-            }
-        }
+UniqueBuckets* buildUniqueBuckets(WordList* dictionaryList) {
+    UniqueBuckets* buckets = malloc(sizeof(UniqueBuckets));
+    int counts[27] = {0};
+    for (int i = 0; i < dictionaryList->numWords; i++) {
+        counts[dictionaryList->uniqueCounts[i]]++;
     }
-    return count;
+    buckets->starts[0] = 0;
+    for (int u = 0; u < 27; u++) {
+        buckets->starts[u + 1] = buckets->starts[u] + counts[u];
+    }
+
+    int next[27];
+    memcpy(next, buckets->starts, sizeof(next));
+    buckets->wordIds = malloc((dictionaryList->numWords + 1) * sizeof(int));
+    for (int i = 0; i < dictionaryList->numWords; i++) {
+        buckets->wordIds[next[dictionaryList->uniqueCounts[i]]++] = i;
+    }
+    return buckets;
 }
 
 /*
-purpose: filter dictionary to only words that use exactly hiveSize unique letters
-parameters: dictionaryList, hiveSize
-returns: new WordList containing those words
-*/WordList* findAllFitWords(WordList* dictionaryList, int hiveSize) {
-    WordList* fitWords = createWordList();
-    
-    for (int i = 0; i < dictionaryList->numWords; i++) {
-        char* w = dictionaryList->words[i];
-        int u = countUniqueLetters(w);
-        if (u == hiveSize){
-            appendWord(fitWords, w);
-        }
+purpose: free all heap memory tied to UniqueBuckets
+parameters: buckets
+returns: nothing
+*/
+void freeUniqueBuckets(UniqueBuckets* buckets) {
+    if (buckets == NULL) {
+        return;
+    }
+    free(buckets->wordIds);
+    free(buckets);
+}
+
+/*
+purpose: pick a random dictionary word that uses exactly hiveSize unique letters
+parameters: buckets, hiveSize
+returns: dictionary index of the word, or -1 if there is none
+*/
+int pickFitWord(UniqueBuckets* buckets, int hiveSize) {
+    int numFitWords = buckets->starts[hiveSize + 1] - buckets->starts[hiveSize];
+    if (numFitWords == 0) {
+        return -1;
     }
-    return fitWords;
+    int pickOne = rand() % numFitWords;
+    return buckets->wordIds[buckets->starts[hiveSize] + pickOne];
 }
 
 /*
@@ -271,160 +989,3718 @@ void printHive(char* hive, int reqLetInd) {
 }
 
 /*
-purpose: show all words in a WordList with their scores
-parameters: thisWordList (words to show), hive 
-returns: nothing
+purpose: find the words in masks[lo..hi-1] that are valid under a hive: a word is
+valid when its letter mask has no bit outside the hive and has the required
+bit, tested 8 or 4 masks at a time with AVX2/SSE2, scalar for the tail
+parameters: masks, lo, hi, outside (~hive mask), reqBit, hits (output, room for hi - lo)
+returns: number of hits written (word indices, ascending)
 */
-void printList(WordList* thisWordList, char* hive) {
-    printf("  Word List:\n");
-    int totScore = 0;
-    for (int i = 0; i < thisWordList->numWords; i++) {
-        char* w = thisWordList->words[i];
-        int length = strlen(w);
-        int points;
-        if (length == 4) {
-            points = 1;
+int scanMasks(unsigned int* masks, int lo, int hi, unsigned int outside, unsigned int reqBit, int* hits) {
+    int numHits = 0;
+    int i = lo;
+
+#if defined(__AVX2__)
+    __m256i vOutside = _mm256_set1_epi32((int)outside);
+    __m256i vReq = _mm256_set1_epi32((int)reqBit);
+    __m256i zero = _mm256_setzero_si256();
+    for (; i + 8 <= hi; i += 8) {
+        __m256i m = _mm256_loadu_si256((__m256i*)(masks + i));
+        __m256i inHive = _mm256_cmpeq_epi32(_mm256_and_si256(m, vOutside), zero);
+        __m256i hasReq = _mm256_cmpeq_epi32(_mm256_and_si256(m, vReq), vReq);
+        int found = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(inHive, hasReq)));
+        while (found != 0) {
+            hits[numHits++] = i + __builtin_ctz(found);
+            found &= found - 1;
         }
-        else {
-            points = length;
+    }
+#elif defined(__SSE2__)
+    __m128i vOutside = _mm_set1_epi32((int)outside);
+    __m128i vReq = _mm_set1_epi32((int)reqBit);
+    __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= hi; i += 4) {
+        __m128i m = _mm_loadu_si128((__m128i*)(masks + i));
+        __m128i inHive = _mm_cmpeq_epi32(_mm_and_si128(m, vOutside), zero);
+        __m128i hasReq = _mm_cmpeq_epi32(_mm_and_si128(m, vReq), vReq);
+        int found = _mm_movemask_ps(_mm_castsi128_ps(_mm_and_si128(inHive, hasReq)));
+        while (found != 0) {
+            hits[numHits++] = i + __builtin_ctz(found);
+            found &= found - 1;
         }
-        if (isPangram(w,hive)){
-            points += strlen(hive);
-            totScore += points;
+    }
+#endif
+
+    // scalar path for the tail (or the whole range without SIMD)
+    for (; i < hi; i++) {
+        if ((masks[i] & outside) == 0 && (masks[i] & reqBit) != 0) {
+            hits[numHits++] = i;
         }
-        printf("    %s\n", w);
     }
-    printf("  Total Score: %d\n", totScore);
+    return numHits;
 }
 
 /*
-purpose: go through every dictionary word and keep it if valid under this hive 
+purpose: go through every dictionary word and keep it if valid under this hive,
+scanning the flat masks column one cache-sized chunk at a time
 parameters: dictionaryList (all words), solvedList (output), hive, reqlet 
 returns: nothing 
 */void bruteForceSolve(WordList* dictionaryList, WordList* solvedList, char* hive, char reqLet) {
-    for (int i = 0; i < dictionaryList->numWords; i++) {
-        if (isValidWord(dictionaryList->words[i], hive, reqLet)) {
-            appendWord(solvedList, dictionaryList->words[i]);
+    unsigned int outside = ~letterMask(hive);
+    unsigned int reqBit = 1u << (reqLet - 'a');
+    int n = dictionaryList->numWords;
+    int* hits = malloc(SOLVE_CHUNK_WORDS * sizeof(int));
+    countStat(&runStats.wordsScanned, n);
+
+    for (int lo = 0; lo < n; lo += SOLVE_CHUNK_WORDS) {
+        int hi = (lo + SOLVE_CHUNK_WORDS < n) ? lo + SOLVE_CHUNK_WORDS : n;
+        int numHits = scanMasks(dictionaryList->masks, lo, hi, outside, reqBit, hits);
+        for (int k = 0; k < numHits; k++) {
+            appendWordRef(solvedList, dictionaryList, hits[k]);
+        }
+    }
+    free(hits);
+}
+
+// shared state of a parallel brute-force solve: workers claim chunks in
+// order and keep their hits in their own buffer until the merge
+typedef struct ParallelSolve_struct {
+    unsigned int* masks; // dictionary masks column
+    int numWords;
+    int numChunks;
+    atomic_int nextChunk; // next chunk nobody has claimed yet
+    unsigned int outside; // ~hive mask
+    unsigned int reqBit;
+    int* chunkOwner; // which worker scanned each chunk
+    int* chunkStart; // where its hits start in that worker's buffer
+    int* chunkCount; // how many hits it had
+} ParallelSolve;
+
+typedef struct SolveWorker_struct {
+    ParallelSolve* solve;
+    int id;
+    int* hits; // this worker's hits, chunk after chunk
+    int numHits;
+    int hitCap;
+} SolveWorker;
+
+/*
+purpose: thread body for parallelBruteForceSolve: scan chunks until none are left
+parameters: arg (SolveWorker*)
+returns: NULL
+*/
+void* solveWorker(void* arg) {
+    SolveWorker* worker = arg;
+    ParallelSolve* solve = worker->solve;
+    while (true) {
+        int chunk = atomic_fetch_add(&solve->nextChunk, 1);
+        if (chunk >= solve->numChunks) {
+            break;
+        }
+        int lo = chunk * SOLVE_CHUNK_WORDS;
+        int hi = (lo + SOLVE_CHUNK_WORDS < solve->numWords) ? lo + SOLVE_CHUNK_WORDS : solve->numWords;
+        if (worker->numHits + (hi - lo) > worker->hitCap) {
+            while (worker->numHits + (hi - lo) > worker->hitCap) {
+                worker->hitCap *= 2;
+            }
+            worker->hits = realloc(worker->hits, worker->hitCap * sizeof(int));
+        }
+        int found = scanMasks(solve->masks, lo, hi, solve->outside, solve->reqBit, worker->hits + worker->numHits);
+        solve->chunkOwner[chunk] = worker->id;
+        solve->chunkStart[chunk] = worker->numHits;
+        solve->chunkCount[chunk] = found;
+        worker->numHits += found;
+    }
+    return NULL;
+}
+
+/*
+purpose: bruteForceSolve split over numThreads threads (-j): chunks are
+filtered into thread-local buffers, then appended in chunk order so the
+result is identical to the serial solve
+parameters: dictionaryList, solvedList (output), hive, reqLet, numThreads
+returns: nothing
+*/
+void parallelBruteForceSolve(WordList* dictionaryList, WordList* solvedList, char* hive, char reqLet, int numThreads) {
+    ParallelSolve solve;
+    solve.masks = dictionaryList->masks;
+    solve.numWords = dictionaryList->numWords;
+    solve.numChunks = (dictionaryList->numWords + SOLVE_CHUNK_WORDS - 1) / SOLVE_CHUNK_WORDS;
+    atomic_init(&solve.nextChunk, 0);
+    solve.outside = ~letterMask(hive);
+    solve.reqBit = 1u << (reqLet - 'a');
+    solve.chunkOwner = malloc((solve.numChunks + 1) * sizeof(int));
+    solve.chunkStart = malloc((solve.numChunks + 1) * sizeof(int));
+    solve.chunkCount = malloc((solve.numChunks + 1) * sizeof(int));
+    countStat(&runStats.wordsScanned, solve.numWords);
+
+    SolveWorker* workers = malloc(numThreads * sizeof(SolveWorker));
+    pthread_t* threads = malloc(numThreads * sizeof(pthread_t));
+    for (int t = 0; t < numThreads; t++) {
+        workers[t].solve = &solve;
+        workers[t].id = t;
+        workers[t].hitCap = SOLVE_CHUNK_WORDS;
+        workers[t].hits = malloc(workers[t].hitCap * sizeof(int));
+        workers[t].numHits = 0;
+        pthread_create(&threads[t], NULL, solveWorker, &workers[t]);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    // merge in dictionary order
+    for (int c = 0; c < solve.numChunks; c++) {
+        int* hits = workers[solve.chunkOwner[c]].hits + solve.chunkStart[c];
+        for (int k = 0; k < solve.chunkCount[c]; k++) {
+            appendWordRef(solvedList, dictionaryList, hits[k]);
+        }
+    }
+
+    for (int t = 0; t < numThreads; t++) {
+        free(workers[t].hits);
+    }
+    free(threads);
+    free(workers);
+    free(solve.chunkOwner);
+    free(solve.chunkStart);
+    free(solve.chunkCount);
+}
+
+/*
+purpose: qsort comparator for 64-bit (mask << 32 | index) keys
+parameters: a, b (pointers to keys)
+returns: negative, zero or positive like strcmp
+*/
+int compareMaskKeys(const void* a, const void* b) {
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return (x > y) - (x < y);
+}
+
+/*
+purpose: group the dictionary by letter mask; words that use a non-letter or
+more than MAX_HIVE_SIZE distinct letters can never be valid, so they are left out
+parameters: dictionaryList
+returns: pointer to a new MaskIndex on the heap
+*/
+MaskIndex* buildMaskIndex(WordList* dictionaryList) {
+    int n = dictionaryList->numWords;
+    unsigned long long* keys = malloc((n + 1) * sizeof(unsigned long long));
+    int numKeys = 0;
+    for (int i = 0; i < n; i++) {
+        unsigned int m = dictionaryList->masks[i];
+        if ((m & NON_LETTER_BIT) == 0 && __builtin_popcount(m) <= MAX_HIVE_SIZE) {
+            keys[numKeys] = ((unsigned long long)m << 32) | (unsigned int)i;
+            numKeys++;
+        }
+    }
+    qsort(keys, numKeys, sizeof(unsigned long long), compareMaskKeys);
+
+    MaskIndex* index = malloc(sizeof(MaskIndex));
+    index->masks = malloc((numKeys + 1) * sizeof(unsigned int));
+    index->starts = malloc((numKeys + 2) * sizeof(int));
+    index->wordIds = malloc((numKeys + 1) * sizeof(int));
+    index->numMasks = 0;
+    index->mapped = false;
+
+    // sorted keys: start a new bucket every time the mask changes
+    for (int k = 0; k < numKeys; k++) {
+        unsigned int m = (unsigned int)(keys[k] >> 32);
+        if (index->numMasks == 0 || index->masks[index->numMasks - 1] != m) {
+            index->masks[index->numMasks] = m;
+            index->starts[index->numMasks] = k;
+            index->numMasks++;
+        }
+        index->wordIds[k] = (int)(keys[k] & 0xffffffffu);
+    }
+    index->starts[index->numMasks] = numKeys;
+
+    free(keys);
+    return index;
+}
+
+/*
+purpose: binary search for the bucket holding exactly this mask
+parameters: index, mask
+returns: bucket number, or -1 if no dictionary word has this letter set
+*/
+int findMaskBucket(MaskIndex* index, unsigned int mask) {
+    int lo = 0;
+    int hi = index->numMasks - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (index->masks[mid] == mask) {
+            return mid;
+        }
+        else if (index->masks[mid] < mask) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid - 1;
+        }
+    }
+    return -1;
+}
+
+/*
+purpose: free all heap memory tied to a MaskIndex
+parameters: index
+returns: nothing
+*/
+void freeMaskIndex(MaskIndex* index) {
+    if (index == NULL) {
+        return;
+    }
+    if (!index->mapped) {
+        free(index->masks);
+        free(index->starts);
+        free(index->wordIds);
+    }
+    free(index);
+}
+
+/*
+purpose: qsort comparator for ints, ascending
+parameters: a, b (pointers to ints)
+returns: negative, zero or positive like strcmp
+*/
+int compareInts(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+/*
+purpose: the word ids of a hive's answers, probing only the letter sets it can
+spell: every submask of the hive that contains the required letter (at most
+2^(k-1) probes), so the cost does not depend on the dictionary size. hits are
+put back in dictionary order so the output matches bruteForceSolve
+parameters: index, hive, reqLet, pHits (output: malloc'd array of word ids)
+returns: number of ids in *pHits
+*/
+int indexHiveHits(MaskIndex* index, char* hive, char reqLet, int** pHits) {
+    unsigned int reqBit = 1u << (reqLet - 'a');
+    unsigned int rest = letterMask(hive) & ~reqBit;
+
+    int numHits = 0;
+    int hitCap = 64;
+    int* hits = malloc(hitCap * sizeof(int));
+
+    // walk all submasks of rest (including 0), each with the required bit added
+    unsigned int sub = rest;
+    while (true) {
+        int b = findMaskBucket(index, sub | reqBit);
+        if (b != -1) {
+            for (int k = index->starts[b]; k < index->starts[b + 1]; k++) {
+                if (numHits >= hitCap) {
+                    hitCap *= 2;
+                    hits = realloc(hits, hitCap * sizeof(int));
+                }
+                hits[numHits] = index->wordIds[k];
+                numHits++;
+            }
+        }
+        if (sub == 0) {
+            break;
+        }
+        sub = (sub - 1) & rest;
+    }
+
+    countStat(&runStats.wordsScanned, numHits);
+    qsort(hits, numHits, sizeof(int), compareInts);
+    *pHits = hits;
+    return numHits;
+}
+
+/*
+purpose: solve a hive with the letter-set index
+parameters: index, dictionaryList, solvedList (output), hive, reqLet
+returns: nothing
+*/
+void indexSolve(MaskIndex* index, WordList* dictionaryList, WordList* solvedList, char* hive, char reqLet) {
+    int* hits;
+    int numHits = indexHiveHits(index, hive, reqLet, &hits);
+    for (int i = 0; i < numHits; i++) {
+        appendWordRef(solvedList, dictionaryList, hits[i]);
+    }
+    free(hits);
+}
+
+// per-letter inverted index: for every letter (and NON_LETTER_BIT) the set of
+// dictionary words containing it, split Roaring-style into containers of
+// 65536 words that are a sorted array when sparse and a bitset when dense
+#define BITMAP_CONTAINER_WORDS 65536
+#define BITMAP_CONTAINER_LONGS (BITMAP_CONTAINER_WORDS / 64)
+#define BITMAP_ARRAY_MAX 4096 // fewer members than this: sorted array (smaller than the bitset)
+#define BITMAP_LETTERS 27 // a-z, then words with a non-letter
+
+typedef struct BitmapContainer_struct {
+    int cardinality; // members in this container
+    unsigned short* members; // sparse: sorted word numbers within the container (else NULL)
+    unsigned long long* bits; // dense: BITMAP_CONTAINER_LONGS words of bits (else NULL)
+} BitmapContainer;
+
+struct LetterBitmaps_struct {
+    int numWords;
+    int numContainers; // per letter
+    BitmapContainer* containers; // containers[letter * numContainers + c]
+};
+
+/*
+purpose: build the per-letter bitmaps from the dictionary masks (two passes:
+count to pick each container's kind, then fill)
+parameters: dictionaryList
+returns: pointer to new LetterBitmaps on the heap
+*/
+LetterBitmaps* buildLetterBitmaps(WordList* dictionaryList) {
+    LetterBitmaps* bitmaps = malloc(sizeof(LetterBitmaps));
+    int n = dictionaryList->numWords;
+    bitmaps->numWords = n;
+    bitmaps->numContainers = (n + BITMAP_CONTAINER_WORDS - 1) / BITMAP_CONTAINER_WORDS;
+    int total = BITMAP_LETTERS * bitmaps->numContainers;
+    bitmaps->containers = calloc(total + 1, sizeof(BitmapContainer));
+
+    for (int i = 0; i < n; i++) {
+        unsigned int mask = dictionaryList->masks[i];
+        int c = i / BITMAP_CONTAINER_WORDS;
+        while (mask != 0) {
+            int letter = __builtin_ctz(mask);
+            bitmaps->containers[letter * bitmaps->numContainers + c].cardinality++;
+            mask &= mask - 1;
+        }
+    }
+    for (int k = 0; k < total; k++) {
+        BitmapContainer* container = &bitmaps->containers[k];
+        if (container->cardinality >= BITMAP_ARRAY_MAX) {
+            container->bits = calloc(BITMAP_CONTAINER_LONGS, sizeof(unsigned long long));
+        }
+        else if (container->cardinality > 0) {
+            container->members = malloc(container->cardinality * sizeof(unsigned short));
+        }
+        container->cardinality = 0; // recounted while filling
+    }
+    for (int i = 0; i < n; i++) {
+        unsigned int mask = dictionaryList->masks[i];
+        int c = i / BITMAP_CONTAINER_WORDS;
+        int low = i % BITMAP_CONTAINER_WORDS;
+        while (mask != 0) {
+            int letter = __builtin_ctz(mask);
+            BitmapContainer* container = &bitmaps->containers[letter * bitmaps->numContainers + c];
+            if (container->bits != NULL) {
+                container->bits[low / 64] |= 1ULL << (low % 64);
+            }
+            else {
+                container->members[container->cardinality] = (unsigned short)low;
+            }
+            container->cardinality++;
+            mask &= mask - 1;
         }
     }
+    return bitmaps;
+}
+
+/*
+purpose: free all heap memory tied to LetterBitmaps
+parameters: bitmaps
+returns: nothing
+*/
+void freeLetterBitmaps(LetterBitmaps* bitmaps) {
+    if (bitmaps == NULL) {
+        return;
+    }
+    for (int k = 0; k < BITMAP_LETTERS * bitmaps->numContainers; k++) {
+        free(bitmaps->containers[k].members);
+        free(bitmaps->containers[k].bits);
+    }
+    free(bitmaps->containers);
+    free(bitmaps);
 }
 
 /*
-purpose: check if partWord is a prefix of fullWord
-parameters: partWord (shorter maybe), fullWord (longer)
-returns: true if partWord matches from fullWord[0...length-1], else false 
-*/bool isPrefix(char* partWord, char* fullWord) {
-    // compare char by char until partWord ends
+purpose: acc &= ~bits over one container's bitset, 256 or 128 bits at a time
+parameters: acc, bits (BITMAP_CONTAINER_LONGS words each)
+returns: nothing
+*/
+void andNotBits(unsigned long long* acc, unsigned long long* bits) {
     int i = 0;
-    while (partWord[i] != '\0') {
-        if (partWord[i] != fullWord[i]) {
-            return false;
+#if defined(__AVX2__)
+    for (; i + 4 <= BITMAP_CONTAINER_LONGS; i += 4) {
+        __m256i a = _mm256_loadu_si256((__m256i*)(acc + i));
+        __m256i b = _mm256_loadu_si256((__m256i*)(bits + i));
+        _mm256_storeu_si256((__m256i*)(acc + i), _mm256_andnot_si256(b, a));
+    }
+#elif defined(__SSE2__)
+    for (; i + 2 <= BITMAP_CONTAINER_LONGS; i += 2) {
+        __m128i a = _mm_loadu_si128((__m128i*)(acc + i));
+        __m128i b = _mm_loadu_si128((__m128i*)(bits + i));
+        _mm_storeu_si128((__m128i*)(acc + i), _mm_andnot_si128(b, a));
+    }
+#endif
+    for (; i < BITMAP_CONTAINER_LONGS; i++) {
+        acc[i] &= ~bits[i];
+    }
+}
+
+/*
+purpose: set query over the dictionary without touching its strings: every
+word that contains all letters of includeMask and none of excludeMask, in
+dictionary order (bit 26 = NON_LETTER_BIT may be used like a letter)
+parameters: bitmaps, includeMask, excludeMask, pHits (output: malloc'd array of word ids)
+returns: number of ids in *pHits
+*/
+int bitmapQuery(LetterBitmaps* bitmaps, unsigned int includeMask, unsigned int excludeMask, int** pHits) {
+    unsigned long long* acc = malloc(BITMAP_CONTAINER_LONGS * sizeof(unsigned long long));
+    int numHits = 0;
+    int hitCap = 64;
+    int* hits = malloc(hitCap * sizeof(int));
+
+    for (int c = 0; c < bitmaps->numContainers; c++) {
+        int base = c * BITMAP_CONTAINER_WORDS;
+        int wordsHere = bitmaps->numWords - base;
+        if (wordsHere > BITMAP_CONTAINER_WORDS) {
+            wordsHere = BITMAP_CONTAINER_WORDS;
+        }
+
+        // start from every word in the container, then intersect the includes
+        memset(acc, 0, BITMAP_CONTAINER_LONGS * sizeof(unsigned long long));
+        memset(acc, 0xff, (wordsHere / 64) * sizeof(unsigned long long));
+        if (wordsHere % 64 != 0) {
+            acc[wordsHere / 64] = (1ULL << (wordsHere % 64)) - 1;
+        }
+        bool empty = false;
+        unsigned int include = includeMask;
+        while (include != 0 && !empty) {
+            BitmapContainer* container = &bitmaps->containers[__builtin_ctz(include) * bitmaps->numContainers + c];
+            include &= include - 1;
+            if (container->cardinality == 0) {
+                empty = true;
+            }
+            else if (container->bits != NULL) {
+                for (int i = 0; i < BITMAP_CONTAINER_LONGS; i++) {
+                    acc[i] &= container->bits[i];
+                }
+            }
+            else {
+                // keep only the array's members: bit k of kept says whether
+                // members[k] is still in acc, then rebuild acc from them
+                unsigned long long kept[BITMAP_ARRAY_MAX / 64 + 1];
+                memset(kept, 0, sizeof(kept));
+                for (int k = 0; k < container->cardinality; k++) {
+                    int low = container->members[k];
+                    if ((acc[low / 64] >> (low % 64)) & 1) {
+                        kept[k / 64] |= 1ULL << (k % 64);
+                    }
+                }
+                memset(acc, 0, BITMAP_CONTAINER_LONGS * sizeof(unsigned long long));
+                for (int k = 0; k < container->cardinality; k++) {
+                    if ((kept[k / 64] >> (k % 64)) & 1) {
+                        int low = container->members[k];
+                        acc[low / 64] |= 1ULL << (low % 64);
+                    }
+                }
+            }
+        }
+        if (empty) {
+            continue;
+        }
+
+        // subtract the excluded letters
+        unsigned int exclude = excludeMask;
+        while (exclude != 0) {
+            BitmapContainer* container = &bitmaps->containers[__builtin_ctz(exclude) * bitmaps->numContainers + c];
+            exclude &= exclude - 1;
+            if (container->bits != NULL) {
+                andNotBits(acc, container->bits);
+            }
+            else {
+                for (int k = 0; k < container->cardinality; k++) {
+                    int low = container->members[k];
+                    acc[low / 64] &= ~(1ULL << (low % 64));
+                }
+            }
+        }
+
+        for (int i = 0; i < BITMAP_CONTAINER_LONGS; i++) {
+            unsigned long long word = acc[i];
+            while (word != 0) {
+                if (numHits >= hitCap) {
+                    hitCap *= 2;
+                    hits = realloc(hits, hitCap * sizeof(int));
+                }
+                hits[numHits] = base + i * 64 + __builtin_ctzll(word);
+                numHits++;
+                word &= word - 1;
+            }
         }
-        i++;
     }
-    if (partWord[i] == '\0') {
-        return true;
+    countStat(&runStats.wordsScanned, numHits);
+    free(acc);
+    *pHits = hits;
+    return numHits;
+}
+
+/*
+purpose: the word ids of a hive's answers from the letter bitmaps: words with
+reqLet and with no letter (or non-letter) outside the hive, in dictionary order
+parameters: bitmaps, hive, reqLet, pHits (output: malloc'd array of word ids)
+returns: number of ids in *pHits
+*/
+int bitmapHiveHits(LetterBitmaps* bitmaps, char* hive, char reqLet, int** pHits) {
+    unsigned int outside = ((1u << 26) - 1) & ~letterMask(hive);
+    return bitmapQuery(bitmaps, 1u << (reqLet - 'a'), outside | NON_LETTER_BIT, pHits);
+}
+
+/*
+purpose: solve a hive with the letter bitmaps
+parameters: bitmaps, dictionaryList, solvedList (output), hive, reqLet
+returns: nothing
+*/
+void bitmapSolve(LetterBitmaps* bitmaps, WordList* dictionaryList, WordList* solvedList, char* hive, char reqLet) {
+    int* hits;
+    int numHits = bitmapHiveHits(bitmaps, hive, reqLet, &hits);
+    for (int i = 0; i < numHits; i++) {
+        appendWordRef(solvedList, dictionaryList, hits[i]);
+    }
+    free(hits);
+}
+
+// constraint queries: a generalized solve (letters allowed / required, length
+// range, pangrams only, first letter) answered through whichever access path
+// the planner estimates to examine the fewest words
+#define QUERY_MAX_LENGTH 32 // longer words share the last length bucket
+#define QUERY_PATH_NONE 0 // the constraints contradict each other: no words
+#define QUERY_PATH_MASK_INDEX 1 // probe the MaskIndex buckets of the allowed submasks
+#define QUERY_PATH_LENGTH_SCAN 2 // scan only the length buckets in range
+#define QUERY_PATH_PREFIX_RANGE 3 // scan the sorted dictionary range of one first letter
+#define QUERY_PATH_BITMAPS 4 // intersect the -m letter bitmaps (must include / must exclude)
+
+typedef struct WordQuery_struct {
+    unsigned int allowedMask; // letters a word may use (the hive)
+    unsigned int requiredMask; // letters a word must use (reqLet plus any extras)
+    int minLength;
+    int maxLength; // -1 = no limit
+    bool pangramsOnly; // must use every allowed letter
+    char startLetter; // first letter, '\0' = any
+} WordQuery;
+
+// dictionary word ids grouped by length, for the length-scan path
+struct LengthBuckets_struct {
+    int starts[QUERY_MAX_LENGTH + 2]; // bucket L is wordIds[starts[L]] ... wordIds[starts[L+1]-1]
+    int* wordIds; // ascending within each bucket
+};
+
+typedef struct QueryPlan_struct {
+    int path; // QUERY_PATH_*
+    long long cost; // estimated words examined (plus probes / index builds)
+    int lo; // prefix range: dictionary words lo .. hi-1; length scan: buckets lo .. hi
+    int hi;
+} QueryPlan;
+
+/*
+purpose: group the dictionary ids by length with one counting sort
+parameters: dictionaryList
+returns: pointer to new LengthBuckets on the heap
+*/
+LengthBuckets* buildLengthBuckets(WordList* dictionaryList) {
+    int n = dictionaryList->numWords;
+    LengthBuckets* buckets = malloc(sizeof(LengthBuckets));
+    memset(buckets->starts, 0, sizeof(buckets->starts));
+    for (int i = 0; i < n; i++) {
+        int length = dictionaryList->lengths[i];
+        buckets->starts[((length < QUERY_MAX_LENGTH) ? length : QUERY_MAX_LENGTH) + 1]++;
+    }
+    for (int L = 0; L <= QUERY_MAX_LENGTH; L++) {
+        buckets->starts[L + 1] += buckets->starts[L];
     }
-    return false; 
+    int fill[QUERY_MAX_LENGTH + 1];
+    memcpy(fill, buckets->starts, sizeof(fill));
+    buckets->wordIds = malloc((n + 1) * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        int length = dictionaryList->lengths[i];
+        buckets->wordIds[fill[(length < QUERY_MAX_LENGTH) ? length : QUERY_MAX_LENGTH]++] = i;
+    }
+    return buckets;
 }
 
 /*
-purpose: recursive binary search for exact aWord: also detect prefix matches 
-parameters: thisWordList, aWord (target/prefix), loInd, hiInd
-returns: index if exact match. -1 if aWord is a prefix, -99 if no match and not a prefix
-*/int findWord(WordList* thisWordList, char* aWord, int loInd, int hiInd) {
-    if (hiInd < loInd) { // Base case 2: aWord not found in words[]
+purpose: free all heap memory tied to LengthBuckets
+parameters: buckets
+returns: nothing
+*/
+void freeLengthBuckets(LengthBuckets* buckets) {
+    if (buckets == NULL) {
+        return;
+    }
+    free(buckets->wordIds);
+    free(buckets);
+}
 
-        if (loInd < thisWordList->numWords && isPrefix(aWord, thisWordList->words[loInd])) { 
-            return -1; //words match this root (partial match)
+/*
+purpose: binary search the sorted dictionary for the first word whose first
+letter is at least c
+parameters: dictionaryList, c
+returns: index (numWords if none)
+*/
+int findFirstLetterStart(WordList* dictionaryList, char c) {
+    int lo = 0;
+    int hi = dictionaryList->numWords;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (dictionaryList->words[mid][0] < c) {
+            lo = mid + 1;
         }
         else {
-            return -99; //no more words matching this root (no match)
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*
+purpose: the full predicate of a query for one dictionary word
+parameters: query, dictionaryList, i
+returns: true if word i satisfies every constraint
+*/
+bool matchesQuery(WordQuery* query, WordList* dictionaryList, int i) {
+    unsigned int mask = dictionaryList->masks[i];
+    int length = dictionaryList->lengths[i];
+    return (mask & ~query->allowedMask) == 0 && (mask & query->requiredMask) == query->requiredMask
+           && (!query->pangramsOnly || mask == query->allowedMask) && length >= query->minLength
+           && (query->maxLength < 0 || length <= query->maxLength)
+           && (query->startLetter == '\0' || dictionaryList->words[i][0] == query->startLetter);
+}
+
+/*
+purpose: pick the access path for a query: every path's cost is the number of
+words it would examine (exact for the length and prefix paths, bounded by the
+probe count for the mask index, which only holds matching letter sets, and one
+per 64 words and letter touched for the bitmaps), plus the one-time cost of
+building an index that does not exist yet (the bitmaps are only used if -m built them)
+parameters: query, dictionaryList
+returns: the plan
+*/
+QueryPlan planWordQuery(WordQuery* query, WordList* dictionaryList) {
+    QueryPlan plan = {QUERY_PATH_NONE, 0, 0, 0};
+    int n = dictionaryList->numWords;
+    int numAllowed = __builtin_popcount(query->allowedMask);
+    if ((query->requiredMask & ~query->allowedMask) != 0 || (query->maxLength >= 0 && query->maxLength < query->minLength)
+        || (query->startLetter != '\0' && (query->allowedMask & (1u << (query->startLetter - 'a'))) == 0)
+        || (query->pangramsOnly && query->maxLength >= 0 && query->maxLength < numAllowed)) {
+        return plan;
+    }
+    long long logN = 1;
+    while ((1LL << logN) < n) {
+        logN++;
+    }
+
+    // length scan: the buckets in range, counted exactly
+    int loLength = (query->minLength < QUERY_MAX_LENGTH) ? query->minLength : QUERY_MAX_LENGTH;
+    if (query->pangramsOnly && numAllowed > loLength) {
+        loLength = (numAllowed < QUERY_MAX_LENGTH) ? numAllowed : QUERY_MAX_LENGTH; // a pangram is at least that long
+    }
+    int hiLength = (query->maxLength < 0 || query->maxLength > QUERY_MAX_LENGTH) ? QUERY_MAX_LENGTH : query->maxLength;
+    long long lengthCost = n; // bucketing pass, if not built yet
+    if (dictionaryList->lengthBuckets != NULL) {
+        lengthCost = dictionaryList->lengthBuckets->starts[hiLength + 1] - dictionaryList->lengthBuckets->starts[loLength];
+    }
+    plan.path = QUERY_PATH_LENGTH_SCAN;
+    plan.cost = lengthCost;
+    plan.lo = loLength;
+    plan.hi = hiLength;
+
+    // prefix range: two binary searches give its exact size
+    if (query->startLetter != '\0') {
+        int lo = findFirstLetterStart(dictionaryList, query->startLetter);
+        int hi = findFirstLetterStart(dictionaryList, query->startLetter + 1);
+        if (hi - lo + 2 * logN < plan.cost) {
+            plan.path = QUERY_PATH_PREFIX_RANGE;
+            plan.cost = hi - lo + 2 * logN;
+            plan.lo = lo;
+            plan.hi = hi;
+        }
+    }
+
+    // mask index: one binary search per allowed submask holding the required
+    // letters (just one for pangrams); its buckets hold only those letter sets
+    if (numAllowed <= MAX_HIVE_SIZE) {
+        int numFree = query->pangramsOnly ? 0 : numAllowed - __builtin_popcount(query->requiredMask);
+        long long numProbes = 1LL << numFree;
+        long long maskCost = numProbes * logN;
+        if (dictionaryList->maskIndex == NULL) {
+            maskCost += (long long)n * logN; // sorting the keys
+        }
+        if (maskCost < plan.cost) {
+            plan.path = QUERY_PATH_MASK_INDEX;
+            plan.cost = maskCost;
+        }
+    }
+
+    // bitmaps: every included and every excluded letter (plus non-letters) is
+    // one pass over the dictionary, 64 words at a time
+    if (dictionaryList->bitmaps != NULL) {
+        int numIncluded = __builtin_popcount(query->pangramsOnly ? query->allowedMask : query->requiredMask);
+        long long bitmapCost = (long long)(numIncluded + (26 - numAllowed) + 1) * ((n + 63) / 64);
+        if (bitmapCost < plan.cost) {
+            plan.path = QUERY_PATH_BITMAPS;
+            plan.cost = bitmapCost;
+        }
+    }
+    return plan;
+}
+
+/*
+purpose: name of a query access path, for the plan printout
+parameters: path (QUERY_PATH_*)
+returns: static string
+*/
+const char* queryPathName(int path) {
+    const char* names[] = {"none", "mask index", "length scan", "prefix range", "letter bitmaps"};
+    return names[path];
+}
+
+/*
+purpose: run a planned query, building the chosen index if needed; the length
+and pangram filters are applied inside the path (buckets out of range are never
+touched) and the hits are appended in dictionary order
+parameters: query, plan, dictionaryList, solvedList (output)
+returns: nothing
+*/
+void runWordQuery(WordQuery* query, QueryPlan* plan, WordList* dictionaryList, WordList* solvedList) {
+    int numHits = 0;
+    int hitCap = 64;
+    int* hits = malloc(hitCap * sizeof(int));
+    long long numScanned = 0;
+
+    if (plan->path == QUERY_PATH_MASK_INDEX) {
+        if (dictionaryList->maskIndex == NULL) {
+            dictionaryList->maskIndex = buildMaskIndex(dictionaryList);
+        }
+        MaskIndex* index = dictionaryList->maskIndex;
+        unsigned int rest = query->pangramsOnly ? 0 : query->allowedMask & ~query->requiredMask;
+        unsigned int base = query->pangramsOnly ? query->allowedMask : query->requiredMask;
+        unsigned int sub = rest;
+        while (true) {
+            int b = findMaskBucket(index, sub | base);
+            if (b != -1) {
+                for (int k = index->starts[b]; k < index->starts[b + 1]; k++) {
+                    int i = index->wordIds[k];
+                    numScanned++;
+                    int length = dictionaryList->lengths[i];
+                    if (length < query->minLength || (query->maxLength >= 0 && length > query->maxLength)
+                        || (query->startLetter != '\0' && dictionaryList->words[i][0] != query->startLetter)) {
+                        continue;
+                    }
+                    if (numHits >= hitCap) {
+                        hitCap *= 2;
+                        hits = realloc(hits, hitCap * sizeof(int));
+                    }
+                    hits[numHits] = i;
+                    numHits++;
+                }
+            }
+            if (sub == 0) {
+                break;
+            }
+            sub = (sub - 1) & rest;
+        }
+        qsort(hits, numHits, sizeof(int), compareInts);
+    }
+    else if (plan->path == QUERY_PATH_LENGTH_SCAN) {
+        if (dictionaryList->lengthBuckets == NULL) {
+            dictionaryList->lengthBuckets = buildLengthBuckets(dictionaryList);
+        }
+        LengthBuckets* buckets = dictionaryList->lengthBuckets;
+        for (int k = buckets->starts[plan->lo]; k < buckets->starts[plan->hi + 1]; k++) {
+            int i = buckets->wordIds[k];
+            numScanned++;
+            if (matchesQuery(query, dictionaryList, i)) {
+                if (numHits >= hitCap) {
+                    hitCap *= 2;
+                    hits = realloc(hits, hitCap * sizeof(int));
+                }
+                hits[numHits] = i;
+                numHits++;
+            }
+        }
+        if (plan->lo != plan->hi) {
+            qsort(hits, numHits, sizeof(int), compareInts);
+        }
+    }
+    else if (plan->path == QUERY_PATH_PREFIX_RANGE) {
+        for (int i = plan->lo; i < plan->hi; i++) {
+            numScanned++;
+            if (matchesQuery(query, dictionaryList, i)) {
+                if (numHits >= hitCap) {
+                    hitCap *= 2;
+                    hits = realloc(hits, hitCap * sizeof(int));
+                }
+                hits[numHits] = i;
+                numHits++;
+            }
+        }
+    }
+    else if (plan->path == QUERY_PATH_BITMAPS) {
+        // the letter sets come out exact (bitmapQuery counts them as scanned),
+        // so only the length and first-letter filters are left
+        free(hits);
+        unsigned int include = query->pangramsOnly ? query->allowedMask : query->requiredMask;
+        unsigned int exclude = (((1u << 26) - 1) & ~query->allowedMask) | NON_LETTER_BIT;
+        int numCandidates = bitmapQuery(dictionaryList->bitmaps, include, exclude, &hits);
+        for (int k = 0; k < numCandidates; k++) {
+            int i = hits[k];
+            int length = dictionaryList->lengths[i];
+            if (length < query->minLength || (query->maxLength >= 0 && length > query->maxLength)
+                || (query->startLetter != '\0' && dictionaryList->words[i][0] != query->startLetter)) {
+                continue;
+            }
+            hits[numHits] = i;
+            numHits++;
+        }
+    }
+
+    countStat(&runStats.wordsScanned, numScanned);
+    for (int i = 0; i < numHits; i++) {
+        appendWordRef(solvedList, dictionaryList, hits[i]);
+    }
+    free(hits);
+}
+
+// compiled dictionary image (-c): a header followed by 8-byte aligned sections
+// that are used in place after mapping the file
+#define SBX_MAGIC "SBX1"
+#define SBX_VERSION 3
+#define SBX_POOL 0 // word strings, '\0' terminated, sorted
+#define SBX_OFFSETS 1 // size_t per word
+#define SBX_LENGTHS 2 // int per word
+#define SBX_MASKS 3 // unsigned int per word
+#define SBX_UNIQUE 4 // unsigned char per word
+#define SBX_INDEX_MASKS 5 // MaskIndex masks
+#define SBX_INDEX_STARTS 6 // MaskIndex starts
+#define SBX_INDEX_WORDS 7 // MaskIndex wordIds
+#define SBX_TRIE_NODES 8 // Trie nodes
+#define SBX_NUM_SECTIONS 9
+
+typedef struct SbxHeader_struct {
+    char magic[4]; // SBX_MAGIC
+    unsigned int version; // SBX_VERSION
+    unsigned long long checksum; // FNV-1a of the header (this field zeroed) and every byte after it
+    int numWords; // words in the image
+    int longest; // longest word length
+    int minLength; // min word length the image was filtered with
+    int numMasks; // MaskIndex buckets
+    unsigned long long sectionStart[SBX_NUM_SECTIONS]; // file offset of each section
+    unsigned long long sectionSize[SBX_NUM_SECTIONS]; // bytes in each section
+} SbxHeader;
+
+/*
+purpose: continue a 64-bit FNV-1a hash over some bytes
+parameters: hash (running value), data, size
+returns: the updated hash
+*/
+unsigned long long fnv1a(unsigned long long hash, const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// MSD radix sort of words in strcmp order: one bucket per byte value (the
+// terminator sorts first), permuted in place American-flag style; small
+// buckets finish with insertion sort. the first level is split across threads.
+// each item carries 4 bytes of its word, so a level reads the strings only
+// every fourth time
+#define RADIX_BUCKETS 256
+#define RADIX_SMALL 32 // buckets this small are insertion sorted
+#define RADIX_PARALLEL_MIN 65536 // fewer words than this are sorted on one thread
+
+// a word being sorted, with its position in the list it came from
+typedef struct SortItem_struct {
+    char* word;
+    int id;
+    unsigned int prefix; // radix sort: word bytes from the last depth that is a multiple of 4
+} SortItem;
+
+// shared state of the threads sorting the first-level buckets
+typedef struct RadixShare_struct {
+    SortItem* items;
+    int* starts; // bucket b is items[starts[b]] ... items[starts[b+1]-1]
+    atomic_int nextBucket; // next bucket for a thread to take
+} RadixShare;
+
+/*
+purpose: sort items that share their first depth bytes by the rest (insertion sort)
+parameters: items, n, depth
+returns: nothing
+*/
+void insertionSortItems(SortItem* items, int n, int depth) {
+    for (int i = 1; i < n; i++) {
+        SortItem item = items[i];
+        int j = i - 1;
+        while (j >= 0 && strcmp(items[j].word + depth, item.word + depth) > 0) {
+            items[j + 1] = items[j];
+            j--;
+        }
+        items[j + 1] = item;
+    }
+}
+
+/*
+purpose: partition items in place by their byte at depth (one counting pass,
+then each item is swapped straight into its bucket)
+parameters: items, n, depth, starts (output: RADIX_BUCKETS + 1 bucket boundaries)
+returns: nothing
+*/
+void radixPartition(SortItem* items, int n, int depth, int* starts) {
+    if (depth % 4 == 0) {
+        for (int i = 0; i < n; i++) {
+            char* rest = items[i].word + depth;
+            unsigned int prefix = 0;
+            for (int k = 0; k < 4 && rest[k] != '\0'; k++) {
+                prefix |= (unsigned int)(unsigned char)rest[k] << (24 - 8 * k);
+            }
+            items[i].prefix = prefix;
+        }
+    }
+    int shift = 24 - 8 * (depth % 4);
+    int counts[RADIX_BUCKETS] = {0};
+    for (int i = 0; i < n; i++) {
+        counts[(items[i].prefix >> shift) & 0xff]++;
+    }
+    int next[RADIX_BUCKETS];
+    starts[0] = 0;
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+        next[b] = starts[b];
+        starts[b + 1] = starts[b] + counts[b];
+    }
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+        while (next[b] < starts[b + 1]) {
+            SortItem item = items[next[b]];
+            int c = (item.prefix >> shift) & 0xff;
+            while (c != b) { // carry it home, picking up the item it displaces
+                SortItem displaced = items[next[c]];
+                items[next[c]] = item;
+                next[c]++;
+                item = displaced;
+                c = (item.prefix >> shift) & 0xff;
+            }
+            items[next[b]] = item;
+            next[b]++;
+        }
+    }
+}
+
+/*
+purpose: sort items that share their first depth bytes (recursing once per
+byte of the longest common prefix, so at most the longest word deep)
+parameters: items, n, depth
+returns: nothing
+*/
+void radixSortItems(SortItem* items, int n, int depth) {
+    if (n < RADIX_SMALL) {
+        insertionSortItems(items, n, depth);
+        return;
+    }
+    int starts[RADIX_BUCKETS + 1];
+    radixPartition(items, n, depth, starts);
+    for (int b = 1; b < RADIX_BUCKETS; b++) { // bucket 0 ended here: all equal
+        if (starts[b + 1] - starts[b] > 1) {
+            radixSortItems(items + starts[b], starts[b + 1] - starts[b], depth + 1);
+        }
+    }
+}
+
+/*
+purpose: radix sort worker: take first-level buckets until none are left
+parameters: arg (RadixShare*)
+returns: NULL
+*/
+void* radixWorker(void* arg) {
+    RadixShare* share = arg;
+    while (true) {
+        int b = atomic_fetch_add(&share->nextBucket, 1);
+        if (b >= RADIX_BUCKETS) {
+            return NULL;
+        }
+        if (b > 0 && share->starts[b + 1] - share->starts[b] > 1) {
+            radixSortItems(share->items + share->starts[b], share->starts[b + 1] - share->starts[b], 1);
+        }
+    }
+}
+
+/*
+purpose: sort words into strcmp order with the MSD radix sort, the first-level
+buckets shared by numThreads threads
+parameters: items, n, numThreads
+returns: nothing
+*/
+void radixSortWords(SortItem* items, int n, int numThreads) {
+    if (numThreads < 2 || n < RADIX_PARALLEL_MIN) {
+        radixSortItems(items, n, 0);
+        return;
+    }
+    RadixShare share;
+    int starts[RADIX_BUCKETS + 1];
+    radixPartition(items, n, 0, starts);
+    share.items = items;
+    share.starts = starts;
+    atomic_init(&share.nextBucket, 0);
+    pthread_t* threads = malloc(numThreads * sizeof(pthread_t));
+    for (int t = 1; t < numThreads; t++) {
+        pthread_create(&threads[t], NULL, radixWorker, &share);
+    }
+    radixWorker(&share);
+    for (int t = 1; t < numThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    free(threads);
+}
+
+/*
+purpose: put a loaded dictionary in sorted order without duplicates (what
+the -o / -a solvers rely on): a pass that finds it already
+strictly ascending skips the sort, otherwise the columns are radix sorted and
+adjacent duplicates dropped. a compiled image was sorted when it was written
+parameters: dictionaryList, numThreads
+returns: number of duplicates removed, or -1 if the list was already sorted
+*/
+int sortWordList(WordList* dictionaryList, int numThreads) {
+    int n = dictionaryList->numWords;
+    if (dictionaryList->columnsMapped) {
+        return -1;
+    }
+    int i = 1;
+    while (i < n && strcmp(dictionaryList->words[i - 1], dictionaryList->words[i]) < 0) {
+        i++;
+    }
+    if (i >= n) {
+        return -1;
+    }
+
+    SortItem* items = malloc((n + 1) * sizeof(SortItem));
+    for (i = 0; i < n; i++) {
+        items[i].word = dictionaryList->words[i];
+        items[i].id = i;
+    }
+    radixSortWords(items, n, numThreads);
+
+    // gather every column in the new order, dropping repeats
+    char** words = malloc(dictionaryList->capacity * sizeof(char*));
+    unsigned int* masks = malloc(dictionaryList->capacity * sizeof(unsigned int));
+    size_t* offsets = malloc(dictionaryList->capacity * sizeof(size_t));
+    int* lengths = malloc(dictionaryList->capacity * sizeof(int));
+    unsigned char* uniqueCounts = malloc(dictionaryList->capacity * sizeof(unsigned char));
+    int kept = 0;
+    for (i = 0; i < n; i++) {
+        if (kept > 0 && strcmp(words[kept - 1], items[i].word) == 0) {
+            continue;
+        }
+        int id = items[i].id;
+        words[kept] = dictionaryList->words[id];
+        masks[kept] = dictionaryList->masks[id];
+        offsets[kept] = dictionaryList->offsets[id];
+        lengths[kept] = dictionaryList->lengths[id];
+        uniqueCounts[kept] = dictionaryList->uniqueCounts[id];
+        kept++;
+    }
+    free(items);
+    free(dictionaryList->words);
+    free(dictionaryList->masks);
+    free(dictionaryList->offsets);
+    free(dictionaryList->lengths);
+    free(dictionaryList->uniqueCounts);
+    dictionaryList->words = words;
+    dictionaryList->masks = masks;
+    dictionaryList->offsets = offsets;
+    dictionaryList->lengths = lengths;
+    dictionaryList->uniqueCounts = uniqueCounts;
+    dictionaryList->numWords = kept;
+
+    // positions moved: the hash set is rebuilt on its next use
+    free(dictionaryList->setSlots);
+    dictionaryList->setSlots = NULL;
+    dictionaryList->setCap = 0;
+    return n - kept;
+}
+
+/*
+purpose: copy a loaded dictionary, in its (already sorted, duplicate-free) order,
+into a list whose pool holds exactly those words back to back; sortWordList
+only reorders the columns, so the loaded pool still has dropped duplicates
+and words in file order
+parameters: dictionaryList
+returns: new WordList on the heap with its own compact pool
+*/
+WordList* buildCompactDictionary(WordList* dictionaryList) {
+    WordList* compactList = createWordList();
+    for (int i = 0; i < dictionaryList->numWords; i++) {
+        appendWord(compactList, dictionaryList->words[i]);
+    }
+    return compactList;
+}
+
+/*
+purpose: write a dictionary (already sorted, with its mask index) as a compiled image
+parameters: filename (output path), dictionaryList, longest (longest word length), minLength
+returns: true on success, false if the file could not be written
+*/
+bool writeCompiledDictionary(char* filename, WordList* dictionaryList, int longest, int minLength) {
+    FILE* f = fopen(filename, "wb");
+    if (f == NULL) {
+        return false;
+    }
+
+    MaskIndex* index = dictionaryList->maskIndex;
+    int n = dictionaryList->numWords;
+    const void* data[SBX_NUM_SECTIONS] = {
+        dictionaryList->pool, dictionaryList->offsets, dictionaryList->lengths,
+        dictionaryList->masks, dictionaryList->uniqueCounts,
+        index->masks, index->starts, index->wordIds, dictionaryList->trie->nodes
+    };
+    unsigned long long sizes[SBX_NUM_SECTIONS] = {
+        dictionaryList->poolUsed, n * sizeof(size_t), n * sizeof(int),
+        n * sizeof(unsigned int), n * sizeof(unsigned char),
+        index->numMasks * sizeof(unsigned int), (index->numMasks + 1) * sizeof(int),
+        index->starts[index->numMasks] * sizeof(int), dictionaryList->trie->numNodes * sizeof(TrieNode)
+    };
+
+    SbxHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SBX_MAGIC, 4);
+    header.version = SBX_VERSION;
+    header.numWords = n;
+    header.longest = longest;
+    header.minLength = minLength;
+    header.numMasks = index->numMasks;
+
+    // lay the sections out first: the checksum covers the header too
+    unsigned long long pos = sizeof(header);
+    for (int s = 0; s < SBX_NUM_SECTIONS; s++) {
+        pos += (8 - pos % 8) % 8;
+        header.sectionStart[s] = pos;
+        header.sectionSize[s] = sizes[s];
+        pos += sizes[s];
+    }
+
+    // header goes last, once the checksum is known
+    fwrite(&header, sizeof(header), 1, f);
+    unsigned long long hash = fnv1a(14695981039346656037ULL, &header, sizeof(header));
+    pos = sizeof(header);
+    char padding[8] = {0};
+    for (int s = 0; s < SBX_NUM_SECTIONS; s++) {
+        size_t pad = header.sectionStart[s] - pos;
+        fwrite(padding, 1, pad, f);
+        hash = fnv1a(hash, padding, pad);
+        fwrite(data[s], 1, sizes[s], f);
+        hash = fnv1a(hash, data[s], sizes[s]);
+        pos = header.sectionStart[s] + sizes[s];
+    }
+    header.checksum = hash;
+
+    fseek(f, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, f);
+    bool ok = !ferror(f);
+    if (fclose(f) != 0) {
+        ok = false;
+    }
+    return ok;
+}
+
+/*
+purpose: check whether an open file starts with the compiled-image magic
+parameters: fd
+returns: true if it is a compiled dictionary
+*/
+bool isCompiledDictionary(int fd) {
+    char magic[4];
+    return pread(fd, magic, 4, 0) == 4 && memcmp(magic, SBX_MAGIC, 4) == 0;
+}
+
+/*
+purpose: check that the mask index and trie of a mapped image stay inside
+their sections: bucket starts ascending from 0 to the word id count, every
+word id below numWords, every trie child range and word id inside bounds
+parameters: base (mapping), header
+returns: true if the solvers can follow them without leaving the image
+*/
+bool checkCompiledIndexes(char* base, SbxHeader* header) {
+    int n = header->numWords;
+    int numMasks = header->numMasks;
+    int* starts = (int*)(base + header->sectionStart[SBX_INDEX_STARTS]);
+    int* wordIds = (int*)(base + header->sectionStart[SBX_INDEX_WORDS]);
+    unsigned long long numIds = header->sectionSize[SBX_INDEX_WORDS] / sizeof(int);
+    if (starts[0] != 0 || (unsigned long long)starts[numMasks] != numIds) {
+        return false;
+    }
+    for (int b = 0; b < numMasks; b++) {
+        if (starts[b + 1] < starts[b]) {
+            return false;
+        }
+    }
+    for (unsigned long long k = 0; k < numIds; k++) {
+        if (wordIds[k] < 0 || wordIds[k] >= n) {
+            return false;
+        }
+    }
+
+    TrieNode* nodes = (TrieNode*)(base + header->sectionStart[SBX_TRIE_NODES]);
+    long long numNodes = header->sectionSize[SBX_TRIE_NODES] / sizeof(TrieNode);
+    for (long long i = 0; i < numNodes; i++) {
+        if (nodes[i].wordId < -1 || nodes[i].wordId >= n) {
+            return false;
+        }
+        if (nodes[i].childMask != 0 && (nodes[i].childStart < 0 || nodes[i].childStart + (long long)__builtin_popcount(nodes[i].childMask) > numNodes)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+purpose: map a compiled image and point the list columns and mask index
+straight into it; only the word pointer array is rebuilt. the header, every
+section size (against numWords, numMasks and the node count), every word
+offset and every index and trie reference are always checked; hashing the
+whole image (which reads every page) only happens when verifyImage is set
+parameters: fd, size (file size), dictionaryList (empty output list), minLength, verifyImage
+returns: length of the longest word, or -1 if the image is invalid
+*/
+int loadCompiledDictionary(int fd, size_t size, WordList* dictionaryList, int minLength, bool verifyImage) {
+    if (size < sizeof(SbxHeader)) {
+        return -1;
+    }
+    char* base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) {
+        return -1;
+    }
+
+    SbxHeader* header = (SbxHeader*)base;
+    bool valid = header->version == SBX_VERSION && header->minLength == minLength && header->numWords > 0;
+    for (int s = 0; valid && s < SBX_NUM_SECTIONS; s++) {
+        valid = header->sectionStart[s] <= size && header->sectionSize[s] <= size - header->sectionStart[s]
+                && header->sectionStart[s] % 8 == 0;
+    }
+    int n = header->numWords;
+    unsigned long long numMasks = (header->numMasks >= 0) ? header->numMasks : 0;
+    valid = valid && header->numMasks >= 0
+            && header->sectionSize[SBX_POOL] > 0 && base[header->sectionStart[SBX_POOL] + header->sectionSize[SBX_POOL] - 1] == '\0'
+            && header->sectionSize[SBX_OFFSETS] == n * sizeof(size_t)
+            && header->sectionSize[SBX_LENGTHS] == n * sizeof(int)
+            && header->sectionSize[SBX_MASKS] == n * sizeof(unsigned int)
+            && header->sectionSize[SBX_UNIQUE] == n * sizeof(unsigned char)
+            && header->sectionSize[SBX_INDEX_MASKS] == numMasks * sizeof(unsigned int)
+            && header->sectionSize[SBX_INDEX_STARTS] == (numMasks + 1) * sizeof(int)
+            && header->sectionSize[SBX_INDEX_WORDS] % sizeof(int) == 0
+            && header->sectionSize[SBX_TRIE_NODES] > 0 && header->sectionSize[SBX_TRIE_NODES] % sizeof(TrieNode) == 0;
+    if (valid && verifyImage) {
+        SbxHeader unsummed = *header;
+        unsummed.checksum = 0;
+        unsigned long long hash = fnv1a(14695981039346656037ULL, &unsummed, sizeof(unsummed));
+        hash = fnv1a(hash, base + sizeof(SbxHeader), size - sizeof(SbxHeader));
+        valid = (hash == header->checksum);
+    }
+    valid = valid && checkCompiledIndexes(base, header);
+    if (!valid) {
+        munmap(base, size);
+        return -1;
+    }
+
+    // word pointers, each offset checked to land inside the pool (and the
+    // length and letter count columns, which other structures index by)
+    char* pool = base + header->sectionStart[SBX_POOL];
+    size_t* offsets = (size_t*)(base + header->sectionStart[SBX_OFFSETS]);
+    int* lengths = (int*)(base + header->sectionStart[SBX_LENGTHS]);
+    unsigned char* uniqueCounts = (unsigned char*)(base + header->sectionStart[SBX_UNIQUE]);
+    char** words = malloc(n * sizeof(char*));
+    for (int i = 0; i < n; i++) {
+        if (offsets[i] >= header->sectionSize[SBX_POOL] || lengths[i] < minLength
+            || (unsigned long long)lengths[i] >= header->sectionSize[SBX_POOL] || uniqueCounts[i] > 26) {
+            free(words);
+            munmap(base, size);
+            return -1;
+        }
+        words[i] = pool + offsets[i];
+    }
+
+    // drop the empty columns createWordList made and use the image's instead
+    free(dictionaryList->masks);
+    free(dictionaryList->offsets);
+    free(dictionaryList->lengths);
+    free(dictionaryList->uniqueCounts);
+    free(dictionaryList->words);
+
+    dictionaryList->mapBase = base;
+    dictionaryList->mapLen = size;
+    dictionaryList->columnsMapped = true;
+    dictionaryList->pool = pool;
+    dictionaryList->poolUsed = header->sectionSize[SBX_POOL];
+    dictionaryList->poolCap = header->sectionSize[SBX_POOL];
+    dictionaryList->offsets = offsets;
+    dictionaryList->lengths = lengths;
+    dictionaryList->masks = (unsigned int*)(base + header->sectionStart[SBX_MASKS]);
+    dictionaryList->uniqueCounts = uniqueCounts;
+    dictionaryList->words = words;
+    dictionaryList->numWords = n;
+    dictionaryList->capacity = n;
+
+    MaskIndex* index = malloc(sizeof(MaskIndex));
+    index->masks = (unsigned int*)(base + header->sectionStart[SBX_INDEX_MASKS]);
+    index->starts = (int*)(base + header->sectionStart[SBX_INDEX_STARTS]);
+    index->wordIds = (int*)(base + header->sectionStart[SBX_INDEX_WORDS]);
+    index->numMasks = header->numMasks;
+    index->mapped = true;
+    dictionaryList->maskIndex = index;
+
+    Trie* trie = malloc(sizeof(Trie));
+    trie->nodes = (TrieNode*)(base + header->sectionStart[SBX_TRIE_NODES]);
+    trie->numNodes = header->sectionSize[SBX_TRIE_NODES] / sizeof(TrieNode);
+    trie->mapped = true;
+    dictionaryList->trie = trie;
+
+    return header->longest;
+}
+
+/*
+purpose: read words from a file and add only words of length >= minLength;
+compiled images are loaded as is, other regular files are mapped, anything
+else goes through the fscanf stream
+parameters: filename (dictionary path), dictionaryList (output list), minLength,
+verifyImage (checksum a compiled image in full)
+returns: length of the longest word added, or -1 on error
+*/
+int buildDictionary(char* filename, WordList* dictionaryList, int minLength, bool verifyImage) {
+
+    FILE* f = fopen(filename, "r");
+    if (f == NULL) {
+        return -1;
+    }
+
+    struct stat info;
+    int longest = -2;
+    if (fstat(fileno(f), &info) == 0 && S_ISREG(info.st_mode) && isCompiledDictionary(fileno(f))) {
+        longest = loadCompiledDictionary(fileno(f), (size_t)info.st_size, dictionaryList, minLength, verifyImage);
+        fclose(f);
+        return longest;
+    }
+    if (fstat(fileno(f), &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        longest = buildDictionaryMapped(fileno(f), (size_t)info.st_size, dictionaryList, minLength);
+    }
+    if (longest == -2) {
+        longest = buildDictionaryStream(f, dictionaryList, minLength);
+    }
+
+    fclose(f);
+
+    return longest;
+}
+
+// one pending prefix of the -a walk: the dictionary range sharing it
+typedef struct WalkFrame_struct {
+    int depth; // prefix length
+    int lo; // words lo .. hi-1 start with the prefix
+    int hi;
+    bool hasReq; // the prefix contains reqLet
+} WalkFrame;
+
+/*
+purpose: first word in lo .. hi-1 (all sharing a prefix of length depth) whose
+next character is at least c
+parameters: dictionaryList, lo, hi, depth, c
+returns: index (hi if none)
+*/
+int findNextCharStart(WordList* dictionaryList, int lo, int hi, int depth, unsigned char c) {
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if ((unsigned char)dictionaryList->words[mid][depth] < c) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*
+purpose: optimized search over the sorted dictionary that walks the hive-space
+like a tree without recursion: an explicit stack holds (prefix length, index
+range) frames, and extending a prefix by a hive letter narrows its parent's
+range with two binary searches on the next character, so the work follows the
+prefixes that exist rather than every prefix tried. words come out in
+dictionary order (hive letters are alphabetized)
+parameters: dictionaryList (sorted), solvedList (output), hive, reqLet
+returns: nothing
+*/
+void findAllMatches(WordList* dictionaryList, WordList* solvedList, char* hive, char reqLet) {
+    int hiveSize = strlen(hive);
+    int stackCap = 16 * hiveSize;
+    WalkFrame* stack = malloc(stackCap * sizeof(WalkFrame));
+    int top = 0;
+    long long numVisited = 0;
+    int maxDepth = 0;
+
+    stack[top].depth = 0;
+    stack[top].lo = 0;
+    stack[top].hi = dictionaryList->numWords;
+    stack[top].hasReq = false;
+    top++;
+
+    while (top > 0) {
+        top--;
+        WalkFrame frame = stack[top];
+        numVisited++;
+        if (frame.depth > maxDepth) {
+            maxDepth = frame.depth;
+        }
+
+        // words equal to the prefix sort first in its range
+        int lo = frame.lo;
+        while (lo < frame.hi && dictionaryList->words[lo][frame.depth] == '\0') {
+            if (frame.hasReq && frame.depth >= MIN_WORD_LENGTH) {
+                appendWordRef(solvedList, dictionaryList, lo);
+            }
+            lo++;
+        }
+
+        // a frame per hive letter that continues some word, pushed last letter
+        // first so the smallest is walked next
+        if (top + hiveSize > stackCap) {
+            stackCap = 2 * stackCap + hiveSize;
+            stack = realloc(stack, stackCap * sizeof(WalkFrame));
+        }
+        int hi = frame.hi;
+        for (int k = hiveSize - 1; k >= 0 && lo < hi; k--) {
+            int start = findNextCharStart(dictionaryList, lo, hi, frame.depth, (unsigned char)hive[k]);
+            if (start < hi && dictionaryList->words[start][frame.depth] == hive[k]) {
+                int end = findNextCharStart(dictionaryList, start, hi, frame.depth, (unsigned char)hive[k] + 1);
+                stack[top].depth = frame.depth + 1;
+                stack[top].lo = start;
+                stack[top].hi = end;
+                stack[top].hasReq = frame.hasReq || hive[k] == reqLet;
+                top++;
+            }
+            hi = start;
+        }
+    }
+
+    countStat(&runStats.wordsScanned, numVisited);
+    countStat(&runStats.walkFrames, numVisited);
+    maxStat(&runStats.walkMaxDepth, maxDepth);
+    free(stack);
+}
+
+/*
+purpose: build the compact trie from the dictionary; words with anything other
+than lower-case a-z can never be spelled from a hive, so they are left out.
+a linked trie (first child / next sibling, siblings in letter order) is built
+first, then laid out breadth first into the compact form
+parameters: dictionaryList
+returns: pointer to a new Trie on the heap
+*/
+Trie* buildTrie(WordList* dictionaryList) {
+    int cap = 1024;
+    int numNodes = 1;
+    int* firstChild = malloc(cap * sizeof(int));
+    int* nextSibling = malloc(cap * sizeof(int));
+    int* wordIds = malloc(cap * sizeof(int));
+    char* letters = malloc(cap * sizeof(char));
+    firstChild[0] = -1;
+    nextSibling[0] = -1;
+    wordIds[0] = -1;
+    letters[0] = '\0';
+
+    for (int i = 0; i < dictionaryList->numWords; i++) {
+        char* w = dictionaryList->words[i];
+        bool lowerOnly = true;
+        for (int k = 0; w[k] != '\0'; k++) {
+            if (w[k] < 'a' || w[k] > 'z') {
+                lowerOnly = false;
+                break;
+            }
+        }
+        if (!lowerOnly) {
+            continue;
+        }
+
+        int node = 0;
+        for (int k = 0; w[k] != '\0'; k++) {
+            // find the child for w[k], or the sibling slot to insert it after
+            int prev = -1;
+            int child = firstChild[node];
+            while (child != -1 && letters[child] < w[k]) {
+                prev = child;
+                child = nextSibling[child];
+            }
+            if (child == -1 || letters[child] != w[k]) {
+                if (numNodes >= cap) {
+                    cap *= 2;
+                    firstChild = realloc(firstChild, cap * sizeof(int));
+                    nextSibling = realloc(nextSibling, cap * sizeof(int));
+                    wordIds = realloc(wordIds, cap * sizeof(int));
+                    letters = realloc(letters, cap * sizeof(char));
+                }
+                int fresh = numNodes;
+                numNodes++;
+                firstChild[fresh] = -1;
+                nextSibling[fresh] = child;
+                wordIds[fresh] = -1;
+                letters[fresh] = w[k];
+                if (prev == -1) {
+                    firstChild[node] = fresh;
+                }
+                else {
+                    nextSibling[prev] = fresh;
+                }
+                child = fresh;
+            }
+            node = child;
+        }
+        if (wordIds[node] == -1) {
+            wordIds[node] = i;
+        }
+    }
+
+    // breadth-first layout: queue position becomes the compact node index
+    Trie* trie = malloc(sizeof(Trie));
+    trie->nodes = malloc(numNodes * sizeof(TrieNode));
+    trie->numNodes = numNodes;
+    trie->mapped = false;
+    int* queue = malloc(numNodes * sizeof(int));
+    int head = 0;
+    int tail = 0;
+    queue[tail++] = 0;
+    while (head < tail) {
+        int old = queue[head];
+        TrieNode* node = &trie->nodes[head];
+        head++;
+        node->childStart = tail;
+        node->childMask = 0;
+        node->wordId = wordIds[old];
+        for (int child = firstChild[old]; child != -1; child = nextSibling[child]) {
+            node->childMask |= 1u << (letters[child] - 'a');
+            queue[tail++] = child;
+        }
+    }
+
+    free(queue);
+    free(firstChild);
+    free(nextSibling);
+    free(wordIds);
+    free(letters);
+    return trie;
+}
+
+/*
+purpose: free all heap memory tied to a Trie
+parameters: trie
+returns: nothing
+*/
+void freeTrie(Trie* trie) {
+    if (trie == NULL) {
+        return;
+    }
+    if (!trie->mapped) {
+        free(trie->nodes);
+    }
+    free(trie);
+}
+
+/*
+purpose: depth-first walk that only follows edges labelled with hive letters,
+adding every word node that is long enough and has passed the required letter;
+letters are visited in order, so words come out alphabetically
+parameters: trie, node (current), depth (prefix length), hasReq (prefix has reqLet),
+hiveMask, reqBit, dictionaryList, solvedList (output)
+returns: nothing
+*/
+void trieCollect(Trie* trie, int node, int depth, bool hasReq, unsigned int hiveMask, unsigned int reqBit, WordList* dictionaryList, WordList* solvedList) {
+    TrieNode* n = &trie->nodes[node];
+    if (n->wordId != -1) {
+        countStat(&runStats.wordsScanned, 1);
+    }
+    if (n->wordId != -1 && hasReq && depth >= MIN_WORD_LENGTH) {
+        appendWordRef(solvedList, dictionaryList, n->wordId);
+    }
+
+    unsigned int next = n->childMask & hiveMask;
+    while (next != 0) {
+        unsigned int bit = next & (~next + 1);
+        int child = n->childStart + __builtin_popcount(n->childMask & (bit - 1));
+        trieCollect(trie, child, depth + 1, hasReq || bit == reqBit, hiveMask, reqBit, dictionaryList, solvedList);
+        next &= next - 1;
+    }
+}
+
+/*
+purpose: optimized solver: walk the trie from the root with the hive letters
+parameters: trie, dictionaryList, solvedList (output), hive, reqLet
+returns: nothing
+*/
+void trieSolve(Trie* trie, WordList* dictionaryList, WordList* solvedList, char* hive, char reqLet) {
+    trieCollect(trie, 0, 0, false, letterMask(hive), 1u << (reqLet - 'a'), dictionaryList, solvedList);
+}
+
+/*
+purpose: empty a list so it can be reused (keeps its allocated columns and pool)
+parameters: thisWordList
+returns: nothing
+*/
+void clearWordList(WordList* thisWordList) {
+    thisWordList->numWords = 0;
+    if (thisWordList->mapBase == NULL) {
+        thisWordList->poolUsed = 0;
+    }
+    if (thisWordList->setSlots != NULL) {
+        memset(thisWordList->setSlots, 0, thisWordList->setCap * sizeof(int));
+    }
+}
+
+// bytes of raw corpus per ingestion chunk (one per worker per round), so
+// memory is the distinct words plus numThreads chunks, whatever the corpus size
+#define INGEST_CHUNK_BYTES (4 << 20)
+
+// one worker's share of an ingestion round
+typedef struct IngestChunk_struct {
+    char* text; // raw bytes, split on a token boundary
+    size_t len;
+    int minLength;
+    WordList* words; // output: normalized, distinct within the chunk
+} IngestChunk;
+
+/*
+purpose: normalize the tokens of one chunk: fold A-Z to a-z and keep a token
+only if it is all letters, at least minLength long and has no more unique
+letters than the biggest hive
+parameters: arg (IngestChunk*)
+returns: NULL
+*/
+void* normalizeChunk(void* arg) {
+    IngestChunk* chunk = arg;
+    char* text = chunk->text;
+    size_t pos = 0;
+    while (pos < chunk->len) {
+        while (pos < chunk->len && isSpaceChar(text[pos])) {
+            pos++;
+        }
+        size_t start = pos;
+        bool allLetters = true;
+        unsigned int seen = 0;
+        while (pos < chunk->len && !isSpaceChar(text[pos])) {
+            char c = text[pos];
+            if (c >= 'A' && c <= 'Z') {
+                c += 'a' - 'A';
+                text[pos] = c;
+            }
+            if (c < 'a' || c > 'z') {
+                allLetters = false;
+            }
+            else {
+                seen |= 1u << (c - 'a');
+            }
+            pos++;
+        }
+        if (pos == start || !allLetters || (int)(pos - start) < chunk->minLength || __builtin_popcount(seen) > MAX_HIVE_SIZE) {
+            continue;
+        }
+        if (pos < chunk->len) {
+            text[pos] = '\0';
+            pos++;
+        }
+        else {
+            text[pos] = '\0'; // the buffer has one spare byte past len
+        }
+        if (!containsWord(chunk->words, text + start)) {
+            appendWord(chunk->words, text + start);
+        }
+    }
+    return NULL;
+}
+
+/*
+purpose: build a dictionary from a raw corpus of any size: read it in chunks
+cut on token boundaries, normalize numThreads chunks at a time in parallel,
+merge the chunk results into one duplicate-free set and finally store the
+words sorted (so the -a walk can rely on sorted, unique input)
+parameters: filename (corpus, "-" for stdin), dictionaryList (output), minLength, numThreads
+returns: length of the longest word added, or -1 on error
+*/
+int ingestCorpus(char* filename, WordList* dictionaryList, int minLength, int numThreads) {
+    int fd = (strcmp(filename, "-") == 0) ? STDIN_FILENO : open(filename, O_RDONLY);
+    if (fd == -1) {
+        return -1;
+    }
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+
+    IngestChunk* chunks = malloc(numThreads * sizeof(IngestChunk));
+    pthread_t* threads = malloc(numThreads * sizeof(pthread_t));
+    for (int t = 0; t < numThreads; t++) {
+        chunks[t].text = malloc(INGEST_CHUNK_BYTES + 1);
+        chunks[t].minLength = minLength;
+        chunks[t].words = createWordList();
+    }
+    WordList* merged = createWordList();
+    char* carry = malloc(INGEST_CHUNK_BYTES); // unfinished token from the last chunk
+    size_t carryLen = 0;
+    bool skipping = false; // inside a token longer than a whole chunk: drop it
+    bool atEnd = false;
+
+    while (!atEnd) {
+        // fill up to numThreads chunks, each ending on whitespace
+        int numChunks = 0;
+        while (numChunks < numThreads && !atEnd) {
+            IngestChunk* chunk = &chunks[numChunks];
+            memcpy(chunk->text, carry, carryLen);
+            size_t len = carryLen;
+            carryLen = 0;
+            while (len < INGEST_CHUNK_BYTES) {
+                ssize_t n = read(fd, chunk->text + len, INGEST_CHUNK_BYTES - len);
+                if (n <= 0) {
+                    atEnd = true;
+                    break;
+                }
+                len += n;
+            }
+            if (skipping) {
+                size_t start = 0;
+                while (start < len && !isSpaceChar(chunk->text[start])) {
+                    start++;
+                }
+                skipping = (start == len);
+                len -= start;
+                memmove(chunk->text, chunk->text + start, len);
+            }
+            if (!atEnd) {
+                size_t cut = len;
+                while (cut > 0 && !isSpaceChar(chunk->text[cut - 1])) {
+                    cut--;
+                }
+                if (cut == 0) {
+                    skipping = true; // no boundary in a whole chunk
+                    continue;
+                }
+                carryLen = len - cut;
+                memcpy(carry, chunk->text + cut, carryLen);
+                len = cut;
+            }
+            chunk->len = len;
+            clearWordList(chunk->words);
+            numChunks++;
+        }
+
+        for (int t = 0; t < numChunks; t++) {
+            pthread_create(&threads[t], NULL, normalizeChunk, &chunks[t]);
+        }
+        for (int t = 0; t < numChunks; t++) {
+            pthread_join(threads[t], NULL);
+            WordList* words = chunks[t].words;
+            for (int i = 0; i < words->numWords; i++) {
+                if (!containsWord(merged, words->words[i])) {
+                    appendWord(merged, words->words[i]);
+                }
+            }
+        }
+    }
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+
+    SortItem* order = malloc((merged->numWords + 1) * sizeof(SortItem));
+    for (int i = 0; i < merged->numWords; i++) {
+        order[i].word = merged->words[i];
+        order[i].id = i;
+    }
+    radixSortWords(order, merged->numWords, numThreads);
+    int longest = 0;
+    for (int i = 0; i < merged->numWords; i++) {
+        appendWord(dictionaryList, order[i].word);
+        if (dictionaryList->lengths[i] > longest) {
+            longest = dictionaryList->lengths[i];
+        }
+    }
+
+    free(order);
+    freeWordList(merged);
+    free(carry);
+    for (int t = 0; t < numThreads; t++) {
+        free(chunks[t].text);
+        freeWordList(chunks[t].words);
+    }
+    free(threads);
+    free(chunks);
+    return longest;
+}
+
+// summary numbers for one solved hive
+typedef struct HiveStats_struct {
+    int numValidWords; // words in the solved list
+    int numPangrams; // words using every hive letter
+    int numPerfectPangrams; // pangrams using each hive letter exactly once
+    int totScore; // total score possible
+    bool isBingo; // every hive letter starts at least one word
+    int longestWord; // length of the longest word
+} HiveStats;
+
+// everything the result printers need from one solved list, filled in a
+// single pass over its columns; reusable across hives (arrays only grow)
+typedef struct HiveReport_struct {
+    HiveStats stats; // totals
+    int* wordScores; // score of each solved word
+    unsigned char* pangramKinds; // per word: 0 plain, 1 pangram, 2 perfect pangram
+    int wordCap; // room in wordScores / pangramKinds
+    int* grid; // grid[length * 26 + letter]: words of that length starting with 'a' + letter
+    int gridLengths; // lengths covered by grid (0 .. gridLengths - 1)
+} HiveReport;
+
+/*
+purpose: make an empty reusable HiveReport
+parameters: none
+returns: pointer to a new HiveReport on the heap
+*/
+HiveReport* createHiveReport() {
+    HiveReport* report = malloc(sizeof(HiveReport));
+    memset(&report->stats, 0, sizeof(HiveStats));
+    report->wordCap = 16;
+    report->wordScores = malloc(report->wordCap * sizeof(int));
+    report->pangramKinds = malloc(report->wordCap * sizeof(unsigned char));
+    report->gridLengths = 16;
+    report->grid = calloc(report->gridLengths * 26, sizeof(int));
+    return report;
+}
+
+/*
+purpose: free all heap memory tied to a HiveReport
+parameters: report
+returns: nothing
+*/
+void freeHiveReport(HiveReport* report) {
+    if (report == NULL) {
+        return;
+    }
+    free(report->wordScores);
+    free(report->pangramKinds);
+    free(report->grid);
+    free(report);
+}
+
+/*
+purpose: one linear pass over a solved list: per-word score and pangram kind,
+totals, bingo, longest word and the first-letter x length grid (a word is a
+pangram when its mask covers the whole hive mask)
+parameters: report (output, reused), solvedList, hive
+returns: nothing
+*/
+void computeHiveReport(HiveReport* report, WordList* solvedList, char* hive) {
+    HiveStats stats = {0, 0, 0, 0, false, 0};
+    unsigned int hiveMask = letterMask(hive);
+    int hiveSize = strlen(hive);
+    unsigned int startMask = 0;
+
+    if (solvedList->numWords > report->wordCap) {
+        report->wordCap = solvedList->numWords;
+        report->wordScores = realloc(report->wordScores, report->wordCap * sizeof(int));
+        report->pangramKinds = realloc(report->pangramKinds, report->wordCap * sizeof(unsigned char));
+    }
+    memset(report->grid, 0, report->gridLengths * 26 * sizeof(int));
+
+    for (int i = 0; i < solvedList->numWords; i++) {
+        int length = solvedList->lengths[i];
+        int thisScore = (length == 4) ? 1 : length;
+        unsigned char kind = 0;
+        if ((solvedList->masks[i] & hiveMask) == hiveMask) {
+            thisScore += hiveSize;
+            stats.numPangrams++;
+            kind = 1;
+            if (length == hiveSize) {
+                stats.numPerfectPangrams++;
+                kind = 2;
+            }
+        }
+        report->wordScores[i] = thisScore;
+        report->pangramKinds[i] = kind;
+        stats.numValidWords++;
+        stats.totScore += thisScore;
+        if (length > stats.longestWord) {
+            stats.longestWord = length;
+        }
+
+        int first = tolower((unsigned char)solvedList->words[i][0]);
+        if (first >= 'a' && first <= 'z') {
+            startMask |= 1u << (first - 'a');
+            if (length >= report->gridLengths) {
+                // rows are per length, so growing only appends zeroed rows
+                int newLengths = length * 2;
+                report->grid = realloc(report->grid, newLengths * 26 * sizeof(int));
+                memset(report->grid + report->gridLengths * 26, 0, (newLengths - report->gridLengths) * 26 * sizeof(int));
+                report->gridLengths = newLengths;
+            }
+            report->grid[length * 26 + (first - 'a')]++;
+        }
+    }
+    stats.isBingo = ((startMask & hiveMask) == hiveMask);
+    report->stats = stats;
+}
+
+/*
+purpose: show all words in a WordList with their scores
+parameters: thisWordList (words to show), hive 
+returns: nothing
+*/
+void printList(WordList* thisWordList, char* hive) {
+    HiveReport* report = createHiveReport();
+    computeHiveReport(report, thisWordList, hive);
+    printf("  Word List:\n");
+    for (int i = 0; i < thisWordList->numWords; i++) {
+        printf("    %s\n", thisWordList->words[i]);
+    }
+    printf("  Total Score: %d\n", report->stats.totScore);
+    freeHiveReport(report);
+}
+
+/*
+purpose: print every solved word with its score, starred if it is a pangram
+parameters: report (computed for solvedList), solvedList
+returns: nothing
+*/
+void printSolvedWords(HiveReport* report, WordList* solvedList) {
+    const char* kindNames[3] = {"none", "pangram", "perfect"};
+    if (outWriter.format == FORMAT_CSV) {
+        outPrintf("word,score,pangram\n");
+    }
+    for (int i = 0; i < solvedList->numWords; i++) {
+        if (outWriter.format == FORMAT_JSONL) {
+            outPrintf("{\"word\":");
+            outQuoted(solvedList->words[i]);
+            outPrintf(",\"score\":%d,\"pangram\":\"%s\"}\n", report->wordScores[i], kindNames[report->pangramKinds[i]]);
+        }
+        else if (outWriter.format == FORMAT_CSV) {
+            outQuoted(solvedList->words[i]);
+            outPrintf(",%d,%s\n", report->wordScores[i], kindNames[report->pangramKinds[i]]);
+        }
+        else if (report->pangramKinds[i] == 2) {
+            outPrintf("  *** (%2d) %s\n", report->wordScores[i], solvedList->words[i]);
+        }
+        else if (report->pangramKinds[i] == 1) {
+            outPrintf("  * (%2d) %s\n", report->wordScores[i], solvedList->words[i]);
+        }
+        else {
+            outPrintf("    (%2d) %s\n", report->wordScores[i], solvedList->words[i]);
+        }
+    }
+    outFlush();
+}
+
+/*
+purpose: print a hive letter x word length table of word counts
+parameters: grid (grid[length * 26 + letter], as in HiveReport), longest (last column), hive
+returns: nothing
+*/
+void printLetterGrid(int* grid, int longest, char* hive) {
+    printf("        ");
+    for (int length = MIN_WORD_LENGTH; length <= longest; length++) {
+        printf("%3d", length);
+    }
+    printf("\n      ");
+    for (int length = MIN_WORD_LENGTH; length <= longest; length++) {
+        printf("---");
+    }
+    printf("\n");
+
+    for (int i = 0; hive[i] != '\0'; i++) {
+        printf("   %c", hive[i]);
+        for (int length = MIN_WORD_LENGTH; length <= longest; length++) {
+            printf("%3d", grid[length * 26 + (hive[i] - 'a')]);
+        }
+        printf("\n");
+    }
+}
+
+/*
+purpose: print the hive letter x word length table of word counts
+parameters: report, hive
+returns: nothing
+*/
+void printFrequencyTable(HiveReport* report, char* hive) {
+    printf("\n  Frequency Table:\n");
+    printLetterGrid(report->grid, report->stats.longestWord, hive);
+}
+
+// solved-hive cache (--cache): an in-memory LRU in front of an append-only
+// file of records, keyed by hive mask + required letter; the file header holds
+// a checksum of the dictionary, so a changed dictionary empties the file
+#define CACHE_MAGIC "SBC1"
+#define CACHE_VERSION 1
+#define CACHE_MEMORY_ENTRIES 1024 // LRU size
+#define NO_CACHE_FILE -1
+
+typedef struct CacheFileHeader_struct {
+    char magic[4];
+    int version;
+    unsigned long long dictChecksum;
+    int minLength;
+    int reserved;
+} CacheFileHeader;
+
+// one record in the file, followed by numIds word indices
+typedef struct CacheRecord_struct {
+    unsigned int key; // cacheKey(hive mask, reqLet)
+    int numIds;
+    HiveStats stats;
+} CacheRecord;
+
+typedef struct CacheEntry_struct {
+    unsigned int key;
+    HiveStats stats;
+    int* wordIds; // solved words, as dictionary indices
+    int numIds;
+    struct CacheEntry_struct* newer; // LRU list, newest first
+    struct CacheEntry_struct* older;
+    struct CacheEntry_struct* nextInBucket;
+} CacheEntry;
+
+// where a key's record is in the file (open addressing, key 0 = empty)
+typedef struct CacheSlot_struct {
+    unsigned int key;
+    size_t offset;
+} CacheSlot;
+
+typedef struct SolveCache_struct {
+    pthread_mutex_t lock; // the daemon's workers share one cache
+    unsigned long long dictChecksum;
+    int minLength;
+    int numWords; // stored word ids must be below this
+    CacheEntry** buckets; // memory tier: hash chains ...
+    int numBuckets;
+    CacheEntry* newest; // ... and the LRU order
+    CacheEntry* oldest;
+    int numEntries;
+    int fd; // disk tier (NO_CACHE_FILE = memory only)
+    char* map; // the file as it was when opened
+    size_t mapLen;
+    CacheSlot* slots; // key -> record offset
+    int slotCap;
+    int numSlots;
+} SolveCache;
+
+/*
+purpose: the cache key of a hive: its letter mask with the required letter in bits 26..30
+parameters: hiveMask, reqLet
+returns: the key (never 0)
+*/
+unsigned int cacheKey(unsigned int hiveMask, char reqLet) {
+    return hiveMask | ((unsigned int)(reqLet - 'a') << 26);
+}
+
+/*
+purpose: checksum of everything a cached result depends on: solved lists
+follow the masks, the stats also use lengths and first letters
+parameters: dictionaryList
+returns: 64-bit checksum
+*/
+unsigned long long dictionaryChecksum(WordList* dictionaryList) {
+    int n = dictionaryList->numWords;
+    unsigned long long hash = fnv1a(14695981039346656037ULL, &n, sizeof(n));
+    hash = fnv1a(hash, dictionaryList->masks, n * sizeof(unsigned int));
+    hash = fnv1a(hash, dictionaryList->lengths, n * sizeof(int));
+    for (int i = 0; i < n; i++) {
+        hash = (hash ^ (unsigned char)dictionaryList->words[i][0]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*
+purpose: remember where a key's record is in the file (rehashing at half full)
+parameters: cache, key, offset
+returns: nothing
+*/
+void cacheSlotInsert(SolveCache* cache, unsigned int key, size_t offset) {
+    if (2 * (cache->numSlots + 1) > cache->slotCap) {
+        CacheSlot* old = cache->slots;
+        int oldCap = cache->slotCap;
+        cache->slotCap = (oldCap == 0) ? 64 : oldCap * 2;
+        cache->slots = calloc(cache->slotCap, sizeof(CacheSlot));
+        cache->numSlots = 0;
+        for (int i = 0; i < oldCap; i++) {
+            if (old[i].key != 0) {
+                cacheSlotInsert(cache, old[i].key, old[i].offset);
+            }
+        }
+        free(old);
+    }
+    int s = (int)((key * 2654435761u) & (cache->slotCap - 1));
+    while (cache->slots[s].key != 0 && cache->slots[s].key != key) {
+        s = (s + 1) & (cache->slotCap - 1);
+    }
+    if (cache->slots[s].key == 0) {
+        cache->numSlots++;
+    }
+    cache->slots[s].key = key;
+    cache->slots[s].offset = offset;
+}
+
+/*
+purpose: find a key's record offset in the file
+parameters: cache, key
+returns: offset, or 0 if the file has no record for it (0 is the header)
+*/
+size_t cacheSlotFind(SolveCache* cache, unsigned int key) {
+    if (cache->slotCap == 0) {
+        return 0;
+    }
+    int s = (int)((key * 2654435761u) & (cache->slotCap - 1));
+    while (cache->slots[s].key != 0) {
+        if (cache->slots[s].key == key) {
+            return cache->slots[s].offset;
+        }
+        s = (s + 1) & (cache->slotCap - 1);
+    }
+    return 0;
+}
+
+/*
+purpose: open a solve cache; with a file, reuse its records if they were made
+for this dictionary, otherwise start the file over
+parameters: filename (NULL = memory only), dictionaryList, minLength
+returns: pointer to a new SolveCache on the heap, or NULL if the file cannot be opened
+*/
+SolveCache* openSolveCache(char* filename, WordList* dictionaryList, int minLength) {
+    int fd = NO_CACHE_FILE;
+    if (filename != NULL) {
+        fd = open(filename, O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd == -1) {
+            return NULL;
+        }
+    }
+
+    SolveCache* cache = calloc(1, sizeof(SolveCache));
+    pthread_mutex_init(&cache->lock, NULL);
+    cache->dictChecksum = dictionaryChecksum(dictionaryList);
+    cache->minLength = minLength;
+    cache->numWords = dictionaryList->numWords;
+    cache->numBuckets = 2 * CACHE_MEMORY_ENTRIES;
+    cache->buckets = calloc(cache->numBuckets, sizeof(CacheEntry*));
+    cache->fd = fd;
+    if (fd == NO_CACHE_FILE) {
+        return cache;
+    }
+
+    flock(fd, LOCK_EX); // other runs may be appending
+    CacheFileHeader header;
+    struct stat info;
+    fstat(fd, &info);
+    bool valid = (info.st_size >= (off_t)sizeof(header) && pread(fd, &header, sizeof(header), 0) == sizeof(header)
+                  && memcmp(header.magic, CACHE_MAGIC, 4) == 0 && header.version == CACHE_VERSION
+                  && header.dictChecksum == cache->dictChecksum && header.minLength == minLength);
+    if (!valid) {
+        // new file, or made for another dictionary: start over
+        ftruncate(fd, 0);
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CACHE_MAGIC, 4);
+        header.version = CACHE_VERSION;
+        header.dictChecksum = cache->dictChecksum;
+        header.minLength = minLength;
+        write(fd, &header, sizeof(header));
+    }
+    else if (info.st_size > (off_t)sizeof(header)) {
+        cache->mapLen = info.st_size;
+        cache->map = mmap(NULL, cache->mapLen, PROT_READ, MAP_SHARED, fd, 0);
+        if (cache->map == MAP_FAILED) {
+            cache->map = NULL;
+            cache->mapLen = 0;
+        }
+        // index the records; a torn record at the end (crash mid-write) is cut off
+        size_t pos = sizeof(header);
+        while (cache->map != NULL && pos + sizeof(CacheRecord) <= cache->mapLen) {
+            CacheRecord* record = (CacheRecord*)(cache->map + pos);
+            size_t size = sizeof(CacheRecord) + (size_t)record->numIds * sizeof(int);
+            if (record->numIds < 0 || record->numIds > dictionaryList->numWords || pos + size > cache->mapLen) {
+                break;
+            }
+            cacheSlotInsert(cache, record->key, pos);
+            pos += size;
+        }
+        if (pos < (size_t)info.st_size) {
+            ftruncate(fd, pos);
+            cache->mapLen = pos;
+        }
+    }
+    flock(fd, LOCK_UN);
+    return cache;
+}
+
+/*
+purpose: check, with the file lock held, that the cache file still belongs to
+this dictionary: another run may have started it over for a different one
+since it was opened (and the mapping may reach past its end)
+parameters: cache, pSize (output: current file size)
+returns: true if the indexed records can still be used
+*/
+bool cacheFileCurrent(SolveCache* cache, size_t* pSize) {
+    CacheFileHeader header;
+    struct stat info;
+    if (fstat(cache->fd, &info) == -1 || info.st_size < (off_t)sizeof(header)
+        || pread(cache->fd, &header, sizeof(header), 0) != sizeof(header)) {
+        return false;
+    }
+    *pSize = info.st_size;
+    return memcmp(header.magic, CACHE_MAGIC, 4) == 0 && header.version == CACHE_VERSION
+           && header.dictChecksum == cache->dictChecksum && header.minLength == cache->minLength;
+}
+
+/*
+purpose: stop using the cache file (it was taken over by another run): the
+memory tier keeps working, nothing more is read from or appended to the file
+parameters: cache (lock held, file lock not held)
+returns: nothing
+*/
+void cacheDropFile(SolveCache* cache) {
+    if (cache->map != NULL) {
+        munmap(cache->map, cache->mapLen);
+    }
+    cache->map = NULL;
+    cache->mapLen = 0;
+    free(cache->slots);
+    cache->slots = NULL;
+    cache->slotCap = 0;
+    cache->numSlots = 0;
+    close(cache->fd);
+    cache->fd = NO_CACHE_FILE;
+}
+
+/*
+purpose: read bytes of the cache file: from the mapping when they lie inside
+it, otherwise (records appended after it was made) from the file
+parameters: cache (file lock held), offset, buffer, size
+returns: true if all size bytes were read
+*/
+bool cacheReadAt(SolveCache* cache, size_t offset, void* buffer, size_t size) {
+    if (offset + size <= cache->mapLen) {
+        memcpy(buffer, cache->map + offset, size);
+        return true;
+    }
+    return pread(cache->fd, buffer, size, offset) == (ssize_t)size;
+}
+
+/*
+purpose: free a SolveCache (its file stays for the next run)
+parameters: cache
+returns: nothing
+*/
+void closeSolveCache(SolveCache* cache) {
+    if (cache == NULL) {
+        return;
+    }
+    CacheEntry* entry = cache->newest;
+    while (entry != NULL) {
+        CacheEntry* older = entry->older;
+        free(entry->wordIds);
+        free(entry);
+        entry = older;
+    }
+    if (cache->map != NULL) {
+        munmap(cache->map, cache->mapLen);
+    }
+    if (cache->fd != NO_CACHE_FILE) {
+        close(cache->fd);
+    }
+    free(cache->slots);
+    free(cache->buckets);
+    pthread_mutex_destroy(&cache->lock);
+    free(cache);
+}
+
+/*
+purpose: put an entry at the front of the LRU list
+parameters: cache, entry (not in the list)
+returns: nothing
+*/
+void cacheLinkNewest(SolveCache* cache, CacheEntry* entry) {
+    entry->older = cache->newest;
+    entry->newer = NULL;
+    if (cache->newest != NULL) {
+        cache->newest->newer = entry;
+    }
+    cache->newest = entry;
+    if (cache->oldest == NULL) {
+        cache->oldest = entry;
+    }
+}
+
+/*
+purpose: take an entry out of the LRU list
+parameters: cache, entry
+returns: nothing
+*/
+void cacheUnlink(SolveCache* cache, CacheEntry* entry) {
+    if (entry->newer != NULL) {
+        entry->newer->older = entry->older;
+    }
+    else {
+        cache->newest = entry->older;
+    }
+    if (entry->older != NULL) {
+        entry->older->newer = entry->newer;
+    }
+    else {
+        cache->oldest = entry->newer;
+    }
+}
+
+/*
+purpose: add a result to the memory tier, evicting the least recently used
+entry when it is full (takes ownership of wordIds)
+parameters: cache, key, stats, wordIds, numIds
+returns: the new entry
+*/
+CacheEntry* cacheRemember(SolveCache* cache, unsigned int key, HiveStats stats, int* wordIds, int numIds) {
+    if (cache->numEntries >= CACHE_MEMORY_ENTRIES) {
+        CacheEntry* victim = cache->oldest;
+        cacheUnlink(cache, victim);
+        CacheEntry** link = &cache->buckets[victim->key % cache->numBuckets];
+        while (*link != victim) {
+            link = &(*link)->nextInBucket;
+        }
+        *link = victim->nextInBucket;
+        free(victim->wordIds);
+        free(victim);
+        cache->numEntries--;
+    }
+    CacheEntry* entry = malloc(sizeof(CacheEntry));
+    entry->key = key;
+    entry->stats = stats;
+    entry->wordIds = wordIds;
+    entry->numIds = numIds;
+    entry->nextInBucket = cache->buckets[key % cache->numBuckets];
+    cache->buckets[key % cache->numBuckets] = entry;
+    cacheLinkNewest(cache, entry);
+    cache->numEntries++;
+    return entry;
+}
+
+/*
+purpose: look a hive up: memory tier first, then the file (a file hit is
+promoted into memory). a file record is only read after the file is checked to
+still be ours and long enough, and it is only used if its key, id count and
+every word id are in range; anything else counts as a miss
+parameters: cache (lock held), key
+returns: the entry, or NULL on a miss
+*/
+CacheEntry* cacheFind(SolveCache* cache, unsigned int key) {
+    for (CacheEntry* entry = cache->buckets[key % cache->numBuckets]; entry != NULL; entry = entry->nextInBucket) {
+        if (entry->key == key) {
+            cacheUnlink(cache, entry);
+            cacheLinkNewest(cache, entry);
+            return entry;
+        }
+    }
+    size_t offset = cacheSlotFind(cache, key);
+    if (offset == 0) {
+        return NULL;
+    }
+    flock(cache->fd, LOCK_SH); // writers truncate or append only under LOCK_EX
+    size_t fileSize;
+    if (!cacheFileCurrent(cache, &fileSize)) {
+        flock(cache->fd, LOCK_UN);
+        cacheDropFile(cache);
+        return NULL;
+    }
+    CacheRecord record;
+    int* wordIds = NULL;
+    bool valid = offset + sizeof(record) <= fileSize && cacheReadAt(cache, offset, &record, sizeof(record))
+                 && record.key == key && record.numIds >= 0 && record.numIds <= cache->numWords
+                 && offset + sizeof(record) + (size_t)record.numIds * sizeof(int) <= fileSize;
+    if (valid) {
+        wordIds = malloc((record.numIds + 1) * sizeof(int));
+        valid = cacheReadAt(cache, offset + sizeof(record), wordIds, record.numIds * sizeof(int));
+    }
+    flock(cache->fd, LOCK_UN);
+    for (int i = 0; valid && i < record.numIds; i++) {
+        valid = wordIds[i] >= 0 && wordIds[i] < cache->numWords;
+    }
+    if (!valid) {
+        free(wordIds);
+        return NULL;
+    }
+    return cacheRemember(cache, key, record.stats, wordIds, record.numIds);
+}
+
+/*
+purpose: append a result to the cache file as one record (one write, under an
+exclusive lock, so concurrent runs never interleave records)
+parameters: cache (lock held), entry
+returns: nothing
+*/
+void cacheAppendRecord(SolveCache* cache, CacheEntry* entry) {
+    size_t size = sizeof(CacheRecord) + (size_t)entry->numIds * sizeof(int);
+    char* buffer = malloc(size);
+    CacheRecord record;
+    memset(&record, 0, sizeof(record));
+    record.key = entry->key;
+    record.numIds = entry->numIds;
+    record.stats = entry->stats;
+    memcpy(buffer, &record, sizeof(record));
+    memcpy(buffer + sizeof(record), entry->wordIds, entry->numIds * sizeof(int));
+
+    flock(cache->fd, LOCK_EX);
+    size_t fileSize;
+    if (!cacheFileCurrent(cache, &fileSize)) {
+        // started over for another dictionary: our records do not belong there
+        flock(cache->fd, LOCK_UN);
+        cacheDropFile(cache);
+        free(buffer);
+        return;
+    }
+    off_t offset = lseek(cache->fd, 0, SEEK_END);
+    if (write(cache->fd, buffer, size) == (ssize_t)size) {
+        cacheSlotInsert(cache, entry->key, (size_t)offset);
+    }
+    flock(cache->fd, LOCK_UN);
+    free(buffer);
+}
+
+/*
+purpose: solve a hive through the cache: a hit fills solvedList from the
+stored word indices without running a solver; a miss asks the letter bitmaps
+or the letter-set index, whichever was built (the brute-force kernel only when
+neither was), stores the result in both tiers and fills solvedList the same way
+(a hive with a repeated letter scores differently from its mask, so it is
+solved but never stored)
+parameters: cache, dictionaryList, solvedList (output), report (scratch for a miss),
+hive, reqLet, stats (output: the hive's totals)
+returns: true on a hit, false if it had to be solved
+*/
+bool cachedSolve(SolveCache* cache, WordList* dictionaryList, WordList* solvedList, HiveReport* report, char* hive, char reqLet, HiveStats* stats) {
+    unsigned int key = cacheKey(letterMask(hive), reqLet);
+    bool storable = (__builtin_popcount(letterMask(hive)) == (int)strlen(hive));
+    pthread_mutex_lock(&cache->lock);
+    CacheEntry* entry = storable ? cacheFind(cache, key) : NULL;
+    if (entry != NULL) {
+        countStat(&runStats.cacheHits, 1);
+        for (int i = 0; i < entry->numIds; i++) {
+            appendWordRef(solvedList, dictionaryList, entry->wordIds[i]);
+        }
+        *stats = entry->stats;
+        pthread_mutex_unlock(&cache->lock);
+        return true;
+    }
+    countStat(&runStats.cacheMisses, 1);
+    pthread_mutex_unlock(&cache->lock);
+
+    int numIds = 0;
+    int* wordIds;
+    if (dictionaryList->bitmaps != NULL) {
+        numIds = bitmapHiveHits(dictionaryList->bitmaps, hive, reqLet, &wordIds);
+    }
+    else if (dictionaryList->maskIndex != NULL) {
+        numIds = indexHiveHits(dictionaryList->maskIndex, hive, reqLet, &wordIds);
+    }
+    else {
+        unsigned int outside = ~letterMask(hive);
+        unsigned int reqBit = 1u << (reqLet - 'a');
+        int n = dictionaryList->numWords;
+        int idCap = SOLVE_CHUNK_WORDS;
+        wordIds = malloc(idCap * sizeof(int));
+        for (int lo = 0; lo < n; lo += SOLVE_CHUNK_WORDS) {
+            int hi = (lo + SOLVE_CHUNK_WORDS < n) ? lo + SOLVE_CHUNK_WORDS : n;
+            if (numIds + (hi - lo) > idCap) {
+                idCap = 2 * idCap + (hi - lo);
+                wordIds = realloc(wordIds, idCap * sizeof(int));
+            }
+            numIds += scanMasks(dictionaryList->masks, lo, hi, outside, reqBit, wordIds + numIds);
+        }
+        countStat(&runStats.wordsScanned, n);
+    }
+    for (int i = 0; i < numIds; i++) {
+        appendWordRef(solvedList, dictionaryList, wordIds[i]);
+    }
+    computeHiveReport(report, solvedList, hive);
+    *stats = report->stats;
+
+    pthread_mutex_lock(&cache->lock);
+    if (storable && cacheFind(cache, key) == NULL) { // another worker may have beaten us to it
+        entry = cacheRemember(cache, key, *stats, wordIds, numIds);
+        if (cache->fd != NO_CACHE_FILE) {
+            cacheAppendRecord(cache, entry);
+        }
+    }
+    else {
+        free(wordIds);
+    }
+    pthread_mutex_unlock(&cache->lock);
+    return false;
+}
+
+// play mode state: the hive is solved once when the game starts and every
+// guess is a hash lookup in the answers, with the totals kept up to date,
+// so a guess costs O(word length) however long the session runs
+typedef struct PlayGame_struct {
+    WordList* answers; // every valid word for the hive (its hash set answers guesses)
+    HiveReport* report; // scores and pangram kinds of the answers, and the totals
+    bool* found; // per answer: already guessed
+    WordList* foundList; // guessed answers, in guess order
+    int score; // points so far
+    int numPangramsFound;
+    int* remaining; // remaining[length * 26 + letter]: answers not found yet
+} PlayGame;
+
+/*
+purpose: start a game: solve the hive and set up the running totals
+parameters: dictionaryList, hive, reqLet
+returns: pointer to a new PlayGame on the heap
+*/
+PlayGame* startPlayGame(WordList* dictionaryList, char* hive, char reqLet) {
+    PlayGame* game = malloc(sizeof(PlayGame));
+    game->answers = createWordList();
+    bruteForceSolve(dictionaryList, game->answers, hive, reqLet);
+    containsWord(game->answers, ""); // build the hash set now, not on the first guess
+    game->report = createHiveReport();
+    computeHiveReport(game->report, game->answers, hive);
+    game->found = calloc(game->answers->numWords + 1, sizeof(bool));
+    game->foundList = createWordList();
+    game->score = 0;
+    game->numPangramsFound = 0;
+    game->remaining = malloc(game->report->gridLengths * 26 * sizeof(int));
+    memcpy(game->remaining, game->report->grid, game->report->gridLengths * 26 * sizeof(int));
+    return game;
+}
+
+/*
+purpose: check one guess and update the totals
+parameters: game, word (lower-case)
+returns: points scored, -1 if the word is not an answer, -2 if it was already found
+*/
+int playGuess(PlayGame* game, char* word) {
+    int index = findWordIndex(game->answers, word);
+    if (index == -1) {
+        return -1;
+    }
+    if (game->found[index]) {
+        return -2;
+    }
+    game->found[index] = true;
+    appendWordRef(game->foundList, game->answers, index);
+    game->score += game->report->wordScores[index];
+    if (game->report->pangramKinds[index] != 0) {
+        game->numPangramsFound++;
+    }
+    int first = tolower((unsigned char)word[0]);
+    if (first >= 'a' && first <= 'z') {
+        game->remaining[game->answers->lengths[index] * 26 + (first - 'a')]--;
+    }
+    return game->report->wordScores[index];
+}
+
+/*
+purpose: free all heap memory tied to a PlayGame
+parameters: game
+returns: nothing
+*/
+void freePlayGame(PlayGame* game) {
+    freeWordList(game->foundList);
+    free(game->found);
+    free(game->remaining);
+    freeHiveReport(game->report);
+    freeWordList(game->answers);
+    free(game);
+}
+
+/*
+purpose: print the column titles for printStatsRow
+parameters: none
+returns: nothing
+*/
+void printStatsHeader() {
+    if (outWriter.format == FORMAT_CSV) {
+        outPrintf("hive,req,words,pangrams,perfect,bingo,score,longest\n");
+    }
+    else if (outWriter.format == FORMAT_TEXT) {
+        outPrintf("  %-12s %3s %7s %8s %7s %5s %7s\n", "hive", "req", "words", "pangrams", "perfect", "bingo", "score");
+    }
+}
+
+/*
+purpose: print one hive + required letter and its stats as a table row
+parameters: hive, reqLet, stats
+returns: nothing
+*/
+void printStatsRow(char* hive, char reqLet, HiveStats* stats) {
+    if (outWriter.format == FORMAT_JSONL) {
+        outPrintf("{\"hive\":\"%s\",\"req\":\"%c\",\"words\":%d,\"pangrams\":%d,\"perfect\":%d,\"bingo\":%s,\"score\":%d,\"longest\":%d}\n",
+                  hive, reqLet, stats->numValidWords, stats->numPangrams, stats->numPerfectPangrams,
+                  stats->isBingo ? "true" : "false", stats->totScore, stats->longestWord);
+    }
+    else if (outWriter.format == FORMAT_CSV) {
+        outPrintf("%s,%c,%d,%d,%d,%s,%d,%d\n", hive, reqLet, stats->numValidWords, stats->numPangrams,
+                  stats->numPerfectPangrams, stats->isBingo ? "yes" : "no", stats->totScore, stats->longestWord);
+    }
+    else {
+        outPrintf("  %-12s %3c %7d %8d %7d %5s %7d\n", hive, reqLet, stats->numValidWords,
+                  stats->numPangrams, stats->numPerfectPangrams, stats->isBingo ? "YES" : "NO", stats->totScore);
+    }
+}
+
+/*
+purpose: print the row for a batch line that is not a legal hive + letter
+parameters: input (the hive as written), reqLet ('\0' if missing)
+returns: nothing
+*/
+void printInvalidRow(char* input, char reqLet) {
+    char req[2] = {reqLet, '\0'};
+    if (outWriter.format == FORMAT_JSONL) {
+        outPrintf("{\"hive\":");
+        outQuoted(input);
+        outPrintf(",\"req\":");
+        outQuoted(req);
+        outPrintf(",\"error\":\"invalid hive\"}\n");
+    }
+    else if (outWriter.format == FORMAT_CSV) {
+        outQuoted(input);
+        outPrintf(",");
+        outQuoted(req);
+        outPrintf(",,,,,,\n");
+    }
+    else {
+        outPrintf("  %-12s %3c   INVALID HIVE\n", input, reqLet == '\0' ? '-' : reqLet);
+    }
+}
+
+// one line of a batch file
+typedef struct BatchJob_struct {
+    char input[32]; // hive as written in the file, for error lines
+    char hive[16]; // sorted hive (room for MAX_HIVE_SIZE letters + '\0')
+    char reqLet; // required letter
+    bool valid; // false if the line was not a legal hive + letter
+    HiveStats stats; // result, filled in by a worker
+} BatchJob;
+
+// a worker's share of the jobs: jobs[head] ... jobs[tail-1]; the owner pops
+// from the head, idle workers steal the back half
+typedef struct WorkQueue_struct {
+    pthread_mutex_t lock;
+    int head;
+    int tail;
+} WorkQueue;
+
+typedef struct BatchPool_struct {
+    WordList* dictionaryList; // shared, read only (with its mask index)
+    BatchJob* jobs;
+    WorkQueue* queues; // one per worker
+    int numWorkers;
+} BatchPool;
+
+typedef struct BatchWorker_struct {
+    BatchPool* pool;
+    int id; // which queue this worker owns
+} BatchWorker;
+
+/*
+purpose: take the next job from the front of a queue
+parameters: queue
+returns: job index, or -1 if the queue is empty
+*/
+int popJob(WorkQueue* queue) {
+    int job = -1;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->head < queue->tail) {
+        job = queue->head;
+        queue->head++;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return job;
+}
+
+/*
+purpose: move the back half of victim's jobs into thief's (empty) queue
+parameters: thief, victim
+returns: true if anything was stolen
+*/
+bool stealJobs(WorkQueue* thief, WorkQueue* victim) {
+    pthread_mutex_lock(&victim->lock);
+    int left = victim->tail - victim->head;
+    if (left == 0) {
+        pthread_mutex_unlock(&victim->lock);
+        return false;
+    }
+    int oldTail = victim->tail;
+    victim->tail -= (left + 1) / 2;
+    int newHead = victim->tail;
+    pthread_mutex_unlock(&victim->lock);
+
+    pthread_mutex_lock(&thief->lock);
+    thief->head = newHead;
+    thief->tail = oldTail;
+    pthread_mutex_unlock(&thief->lock);
+    return true;
+}
+
+/*
+purpose: worker thread: solve jobs from its own queue, steal when it runs dry,
+and quit once every queue is empty (jobs are never added after start)
+parameters: arg (BatchWorker*)
+returns: NULL
+*/
+void* batchWorker(void* arg) {
+    BatchWorker* worker = arg;
+    BatchPool* pool = worker->pool;
+    WordList* dictionaryList = pool->dictionaryList;
+    WordList* solvedList = createWordList();
+    HiveReport* report = createHiveReport();
+
+    while (true) {
+        int job = popJob(&pool->queues[worker->id]);
+        if (job == -1) {
+            bool stole = false;
+            for (int k = 1; k < pool->numWorkers && !stole; k++) {
+                int victim = (worker->id + k) % pool->numWorkers;
+                stole = stealJobs(&pool->queues[worker->id], &pool->queues[victim]);
+            }
+            if (!stole) {
+                break;
+            }
+            continue;
+        }
+
+        BatchJob* thisJob = &pool->jobs[job];
+        if (thisJob->valid) {
+            clearWordList(solvedList);
+            if (dictionaryList->bitmaps != NULL) {
+                bitmapSolve(dictionaryList->bitmaps, dictionaryList, solvedList, thisJob->hive, thisJob->reqLet);
+            }
+            else {
+                indexSolve(dictionaryList->maskIndex, dictionaryList, solvedList, thisJob->hive, thisJob->reqLet);
+            }
+            computeHiveReport(report, solvedList, thisJob->hive);
+            thisJob->stats = report->stats;
+        }
+    }
+
+    freeHiveReport(report);
+    freeWordList(solvedList);
+    return NULL;
+}
+
+/*
+purpose: check one batch line: hive of MIN_HIVE_SIZE..MAX_HIVE_SIZE unique
+lower-case letters and a required letter from it
+parameters: input (hive text), reqInp (required letter text), job (output)
+returns: nothing (job->valid says whether it was legal)
+*/
+void parseBatchJob(char* input, char* reqInp, BatchJob* job) {
+    snprintf(job->input, sizeof(job->input), "%s", input);
+    job->valid = false;
+    job->hive[0] = '\0';
+    job->reqLet = reqInp[0];
+
+    int length = strlen(input);
+    if (length < MIN_HIVE_SIZE || length > MAX_HIVE_SIZE || strlen(reqInp) != 1) {
+        return;
+    }
+    unsigned int seen = 0;
+    for (int i = 0; i < length; i++) {
+        if (input[i] < 'a' || input[i] > 'z' || (seen & (1u << (input[i] - 'a'))) != 0) {
+            return;
+        }
+        seen |= 1u << (input[i] - 'a');
+    }
+    if (findLetter(input, job->reqLet) == -1) {
+        return;
+    }
+    buildHive(input, job->hive);
+    job->valid = true;
+}
+
+/*
+purpose: batch mode: read "hive reqLetter" lines, solve them all on a pool of
+work-stealing threads (the dictionary and its index are shared), then print
+one result line per input line, in input order
+parameters: dictionaryList, batchFile, numThreads
+returns: true on success, false if the file could not be read
+*/
+bool runBatch(WordList* dictionaryList, char* batchFile, int numThreads) {
+    FILE* f = fopen(batchFile, "r");
+    if (f == NULL) {
+        return false;
+    }
+
+    int numJobs = 0;
+    int jobCap = 64;
+    BatchJob* jobs = malloc(jobCap * sizeof(BatchJob));
+    char line[256];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char input[100];
+        char reqInp[100];
+        int fields = sscanf(line, "%99s %99s", input, reqInp);
+        if (fields <= 0) {
+            continue; // blank line
+        }
+        if (fields == 1) {
+            reqInp[0] = '\0';
+        }
+        if (numJobs >= jobCap) {
+            jobCap *= 2;
+            jobs = realloc(jobs, jobCap * sizeof(BatchJob));
+        }
+        parseBatchJob(input, reqInp, &jobs[numJobs]);
+        numJobs++;
+    }
+    fclose(f);
+
+    // workers solve with the -m bitmaps when they were built at load, else the index
+    if (dictionaryList->bitmaps == NULL && dictionaryList->maskIndex == NULL) {
+        dictionaryList->maskIndex = buildMaskIndex(dictionaryList);
+    }
+
+    // deal the jobs out in contiguous slices, one per worker
+    if (numThreads > numJobs) {
+        numThreads = numJobs;
+    }
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    BatchPool pool;
+    pool.dictionaryList = dictionaryList;
+    pool.jobs = jobs;
+    pool.numWorkers = numThreads;
+    pool.queues = malloc(numThreads * sizeof(WorkQueue));
+    BatchWorker* workers = malloc(numThreads * sizeof(BatchWorker));
+    pthread_t* threads = malloc(numThreads * sizeof(pthread_t));
+    for (int t = 0; t < numThreads; t++) {
+        pthread_mutex_init(&pool.queues[t].lock, NULL);
+        pool.queues[t].head = (int)((long)numJobs * t / numThreads);
+        pool.queues[t].tail = (int)((long)numJobs * (t + 1) / numThreads);
+        workers[t].pool = &pool;
+        workers[t].id = t;
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_create(&threads[t], NULL, batchWorker, &workers[t]);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_mutex_destroy(&pool.queues[t].lock);
+    }
+
+    printStatsHeader();
+    for (int j = 0; j < numJobs; j++) {
+        if (!jobs[j].valid) {
+            printInvalidRow(jobs[j].input, jobs[j].reqLet);
+            continue;
+        }
+        printStatsRow(jobs[j].hive, jobs[j].reqLet, &jobs[j].stats);
+    }
+    outFlush();
+
+    free(threads);
+    free(workers);
+    free(pool.queues);
+    free(jobs);
+    return true;
+}
+
+// totals for all dictionary words sharing one letter mask (one MaskIndex bucket)
+typedef struct MaskStats_struct {
+    unsigned int mask; // the letter set (0 marks an empty hash slot)
+    int count; // words in the bucket
+    int baseScore; // their scores without pangram bonus
+    int numPerfect; // words whose length equals their number of distinct letters
+    int longest; // longest word length
+    unsigned int startMask; // letters that start at least one of them
+} MaskStats;
+
+// precomputed per-mask totals in an open-addressing hash table, so summing a
+// hive's subsets costs one probe per subset instead of a binary search
+typedef struct MaskStatsTable_struct {
+    MaskStats* slots; // capacity slots, power of two
+    int capacity;
+} MaskStatsTable;
+
+// stats for every hive of one size that has a pangram, for every choice of
+// required letter; rows are in alphabetical hive order
+typedef struct HiveTable_struct {
+    int hiveSize; // letters per hive
+    int numHives; // how many hives (rows)
+    unsigned int* hives; // hive letter masks
+    HiveStats* stats; // stats[h * hiveSize + j]: hive h with its j-th letter required
+} HiveTable;
+
+/*
+purpose: qsort comparator putting hive masks in alphabetical order of their
+letters (the hive with the lowest letter where they differ comes first)
+parameters: a, b (pointers to unsigned int masks)
+returns: negative, zero or positive like strcmp
+*/
+int compareHiveMasks(const void* a, const void* b) {
+    unsigned int x = *(const unsigned int*)a;
+    unsigned int y = *(const unsigned int*)b;
+    if (x == y) {
+        return 0;
+    }
+    unsigned int low = (x ^ y) & (~(x ^ y) + 1);
+    return ((x & low) != 0) ? -1 : 1;
+}
+
+/*
+purpose: turn a letter mask back into its sorted hive string
+parameters: mask, hive (output buffer, MAX_HIVE_SIZE + 1)
+returns: nothing
+*/
+void maskToHive(unsigned int mask, char* hive) {
+    int count = 0;
+    for (int c = 0; c < 26; c++) {
+        if ((mask & (1u << c)) != 0) {
+            hive[count] = 'a' + c;
+            count++;
+        }
+    }
+    hive[count] = '\0';
+}
+
+/*
+purpose: hash slot of a mask in a MaskStatsTable (linear probing)
+parameters: table, mask (nonzero)
+returns: the slot holding mask, or the empty slot where it would go
+*/
+int findMaskStatsSlot(MaskStatsTable* table, unsigned int mask) {
+    int slotMask = table->capacity - 1;
+    int slot = (int)((mask * 2654435761u) >> 7) & slotMask;
+    while (table->slots[slot].mask != 0 && table->slots[slot].mask != mask) {
+        slot = (slot + 1) & slotMask;
+    }
+    return slot;
+}
+
+/*
+purpose: look up the totals of one letter set
+parameters: table, mask
+returns: pointer to its MaskStats, or NULL if no dictionary word has that letter set
+*/
+MaskStats* findMaskStats(MaskStatsTable* table, unsigned int mask) {
+    MaskStats* entry = &table->slots[findMaskStatsSlot(table, mask)];
+    return (entry->mask == 0) ? NULL : entry;
+}
+
+/*
+purpose: fold each mask bucket into one MaskStats, once for the whole dictionary
+parameters: dictionaryList, index (its mask index)
+returns: pointer to a new MaskStatsTable on the heap
+*/
+MaskStatsTable* buildMaskStats(WordList* dictionaryList, MaskIndex* index) {
+    MaskStatsTable* table = malloc(sizeof(MaskStatsTable));
+    table->capacity = 16;
+    while (table->capacity < 2 * index->numMasks) {
+        table->capacity *= 2;
+    }
+    table->slots = calloc(table->capacity, sizeof(MaskStats));
+
+    for (int b = 0; b < index->numMasks; b++) {
+        MaskStats* entry = &table->slots[findMaskStatsSlot(table, index->masks[b])];
+        entry->mask = index->masks[b];
+        int uniques = __builtin_popcount(index->masks[b]);
+        for (int k = index->starts[b]; k < index->starts[b + 1]; k++) {
+            int w = index->wordIds[k];
+            int length = dictionaryList->lengths[w];
+            entry->count++;
+            entry->baseScore += (length == 4) ? 1 : length;
+            if (length == uniques) {
+                entry->numPerfect++;
+            }
+            if (length > entry->longest) {
+                entry->longest = length;
+            }
+            int first = tolower((unsigned char)dictionaryList->words[w][0]);
+            entry->startMask |= 1u << (first - 'a');
+        }
+    }
+    return table;
+}
+
+/*
+purpose: free all heap memory tied to a MaskStatsTable
+parameters: table
+returns: nothing
+*/
+void freeMaskStats(MaskStatsTable* table) {
+    if (table == NULL) {
+        return;
+    }
+    free(table->slots);
+    free(table);
+}
+
+/*
+purpose: fill the stats of one hive for all its required letters at once:
+this is the subset sum of the per-mask totals over the hive, and each of
+the 2^k letter sets inside the hive is probed a single time and added to
+every required letter it contains
+parameters: maskStats, hiveMask, hiveSize, row (output, hiveSize entries)
+returns: nothing
+*/
+void fillHiveRow(MaskStatsTable* maskStats, unsigned int hiveMask, int hiveSize, HiveStats* row) {
+    unsigned int letters[26];
+    int count[26] = {0};
+    int baseScore[26] = {0};
+    int longest[26] = {0};
+    unsigned int startMask[26] = {0};
+    int j = 0;
+    for (int c = 0; c < 26; c++) {
+        if ((hiveMask & (1u << c)) != 0) {
+            letters[j] = 1u << c;
+            j++;
+        }
+    }
+
+    for (unsigned int sub = hiveMask; sub != 0; sub = (sub - 1) & hiveMask) {
+        MaskStats* entry = findMaskStats(maskStats, sub);
+        if (entry == NULL) {
+            continue;
+        }
+        for (j = 0; j < hiveSize; j++) {
+            if ((sub & letters[j]) != 0) {
+                count[j] += entry->count;
+                baseScore[j] += entry->baseScore;
+                startMask[j] |= entry->startMask;
+                if (entry->longest > longest[j]) {
+                    longest[j] = entry->longest;
+                }
+            }
+        }
+    }
+
+    // pangrams are exactly the words whose letter set is the whole hive
+    MaskStats* full = findMaskStats(maskStats, hiveMask);
+    int numPangrams = (full == NULL) ? 0 : full->count;
+    int numPerfect = (full == NULL) ? 0 : full->numPerfect;
+    for (j = 0; j < hiveSize; j++) {
+        row[j].numValidWords = count[j];
+        row[j].numPangrams = numPangrams;
+        row[j].numPerfectPangrams = numPerfect;
+        row[j].totScore = baseScore[j] + numPangrams * hiveSize;
+        row[j].isBingo = ((startMask[j] & hiveMask) == hiveMask);
+        row[j].longestWord = longest[j];
+    }
+}
+
+/*
+purpose: stats of one hive with one required letter without solving it:
+one subset-sum over the precomputed per-mask totals (at most 2^k probes)
+parameters: maskStats, hiveMask, reqLet (must be in the hive)
+returns: the HiveStats
+*/
+HiveStats queryHiveStats(MaskStatsTable* maskStats, unsigned int hiveMask, char reqLet) {
+    HiveStats row[26];
+    fillHiveRow(maskStats, hiveMask, __builtin_popcount(hiveMask), row);
+    unsigned int reqBit = 1u << (reqLet - 'a');
+    return row[__builtin_popcount(hiveMask & (reqBit - 1))];
+}
+
+typedef struct HiveTableWorker_struct {
+    HiveTable* table;
+    MaskStatsTable* maskStats;
+    int first; // this worker fills rows first, first + step, ...
+    int step;
+} HiveTableWorker;
+
+/*
+purpose: thread body for buildHiveTable
+parameters: arg (HiveTableWorker*)
+returns: NULL
+*/
+void* hiveTableWorker(void* arg) {
+    HiveTableWorker* worker = arg;
+    HiveTable* table = worker->table;
+    for (int h = worker->first; h < table->numHives; h += worker->step) {
+        fillHiveRow(worker->maskStats, table->hives[h], table->hiveSize, &table->stats[h * table->hiveSize]);
+    }
+    return NULL;
+}
+
+/*
+purpose: enumerate every hive of hiveSize letters that has a pangram in the
+dictionary and compute its stats for each required letter; the per-mask
+totals are shared by all hives and the rows are split across threads
+parameters: dictionaryList, hiveSize, numThreads
+returns: pointer to a new HiveTable on the heap
+*/
+HiveTable* buildHiveTable(WordList* dictionaryList, int hiveSize, int numThreads) {
+    if (dictionaryList->maskIndex == NULL) {
+        dictionaryList->maskIndex = buildMaskIndex(dictionaryList);
+    }
+    MaskIndex* index = dictionaryList->maskIndex;
+    MaskStatsTable* maskStats = buildMaskStats(dictionaryList, index);
+
+    HiveTable* table = malloc(sizeof(HiveTable));
+    table->hiveSize = hiveSize;
+    table->numHives = 0;
+    table->hives = malloc((index->numMasks + 1) * sizeof(unsigned int));
+    for (int b = 0; b < index->numMasks; b++) {
+        if (__builtin_popcount(index->masks[b]) == hiveSize) {
+            table->hives[table->numHives] = index->masks[b];
+            table->numHives++;
+        }
+    }
+    qsort(table->hives, table->numHives, sizeof(unsigned int), compareHiveMasks);
+    table->stats = malloc(((size_t)table->numHives * hiveSize + 1) * sizeof(HiveStats));
+
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    HiveTableWorker* workers = malloc(numThreads * sizeof(HiveTableWorker));
+    pthread_t* threads = malloc(numThreads * sizeof(pthread_t));
+    for (int t = 0; t < numThreads; t++) {
+        workers[t].table = table;
+        workers[t].maskStats = maskStats;
+        workers[t].first = t;
+        workers[t].step = numThreads;
+        pthread_create(&threads[t], NULL, hiveTableWorker, &workers[t]);
+    }
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    free(threads);
+    free(workers);
+    freeMaskStats(maskStats);
+    return table;
+}
+
+/*
+purpose: free all heap memory tied to a HiveTable
+parameters: table
+returns: nothing
+*/
+void freeHiveTable(HiveTable* table) {
+    if (table == NULL) {
+        return;
+    }
+    free(table->hives);
+    free(table->stats);
+    free(table);
+}
+
+/*
+purpose: enumeration mode: print the stats of every (hive, required letter)
+pair for hives of hiveSize letters that have a pangram
+parameters: dictionaryList, hiveSize, numThreads
+returns: nothing
+*/
+void runEnumeration(WordList* dictionaryList, int hiveSize, int numThreads) {
+    HiveTable* table = buildHiveTable(dictionaryList, hiveSize, numThreads);
+    printf("  %d hives of %d letters have a pangram\n\n", table->numHives, hiveSize);
+    printStatsHeader();
+    char hive[MAX_HIVE_SIZE + 1];
+    for (int h = 0; h < table->numHives; h++) {
+        maskToHive(table->hives[h], hive);
+        for (int j = 0; j < hiveSize; j++) {
+            printStatsRow(hive, hive[j], &table->stats[h * hiveSize + j]);
+        }
+    }
+    outFlush();
+    freeHiveTable(table);
+}
+
+// reply being built for one daemon request (grows as needed, reused per worker)
+typedef struct ReplyBuffer_struct {
+    char* text;
+    int len;
+    int cap;
+} ReplyBuffer;
+
+/*
+purpose: printf onto the end of a reply
+parameters: reply, format + arguments as for printf
+returns: nothing
+*/
+void replyPrintf(ReplyBuffer* reply, const char* format, ...) {
+    while (true) {
+        va_list args;
+        va_start(args, format);
+        int needed = vsnprintf(reply->text + reply->len, reply->cap - reply->len, format, args);
+        va_end(args);
+        if (reply->len + needed < reply->cap) {
+            reply->len += needed;
+            return;
+        }
+        while (reply->cap <= reply->len + needed) {
+            reply->cap *= 2;
+        }
+        reply->text = realloc(reply->text, reply->cap);
+    }
+}
+
+// longest request line the daemon accepts; longer ones drop the client
+#define SERVER_MAX_LINE 1024
+#define SERVER_MAX_EVENTS 64
+// a client that takes no reply bytes for this long is dropped, so one that
+// never reads cannot hold a worker
+#define SERVER_SEND_TIMEOUT_MS 2000
+#define SERVER_POLL_SLICE_MS 100 // ... checking for shutdown this often while waiting
+
+// one client of the daemon; a connection is handed to at most one worker at a
+// time, so its replies always go out in request order
+typedef struct ServerConn_struct {
+    int fd;
+    pthread_mutex_t lock; // guards everything below
+    char inBuf[SERVER_MAX_LINE]; // bytes read but not answered yet
+    int inLen;
+    bool busy; // queued for or held by a worker
+    bool closed; // peer hung up while busy: the worker closes and frees it
+    struct ServerConn_struct* nextReady; // link in the ready queue
+} ServerConn;
+
+typedef struct SolverServer_struct {
+    WordList* dictionaryList; // shared, read only: mask index and hash set built up front
+    MaskStatsTable* maskStats; // for stats queries
+    SolveCache* cache; // solved hives (has its own lock)
+    UniqueBuckets* buckets; // for random hives
+    pthread_mutex_t queueLock;
+    pthread_cond_t queueReady;
+    ServerConn* readyHead; // connections with complete lines, oldest first
+    ServerConn* readyTail;
+    bool stopping; // workers quit once the queue is empty
+} SolverServer;
+
+// set by SIGINT/SIGTERM; the event loop checks it after every wakeup
+volatile sig_atomic_t serverStopRequested = 0;
+
+void requestServerStop(int signum) {
+    (void)signum;
+    serverStopRequested = 1;
+}
+
+/*
+purpose: send a whole buffer on a non-blocking socket, waiting whenever it is
+full, but never longer than SERVER_SEND_TIMEOUT_MS without progress (and not
+past a shutdown request)
+parameters: fd, data, size
+returns: true if everything was sent, false if the peer went away or stopped reading
+*/
+bool sendAll(int fd, char* data, int size) {
+    int sent = 0;
+    while (sent < size) {
+        ssize_t n = send(fd, data + sent, size - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += n;
+        }
+        else if (n == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd p = {fd, POLLOUT, 0};
+            int waited = 0;
+            while (poll(&p, 1, SERVER_POLL_SLICE_MS) == 0) {
+                waited += SERVER_POLL_SLICE_MS;
+                if (waited >= SERVER_SEND_TIMEOUT_MS || serverStopRequested) {
+                    return false;
+                }
+            }
+        }
+        else if (n == -1 && errno == EINTR) {
+            continue;
+        }
+        else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+purpose: answer one request line of the daemon protocol:
+    solve <hive> <reqLetter>        OK <words> <score> <word> <word> ...
+    valid <hive> <reqLetter> <word> OK yes <score>  or  OK no
+    stats <hive> <reqLetter>        OK words=.. pangrams=.. perfect=.. score=.. bingo=.. longest=..
+    random <size>                   OK <hive> <reqLetter>
+    quit                            OK bye (serverWorker then closes the connection)
+errors are answered with ERR <reason>
+parameters: server, line ('\0'-terminated, no newline), solvedList + report (worker scratch), reply (output)
+returns: true if the client asked to quit
+*/
+bool handleServerRequest(SolverServer* server, char* line, WordList* solvedList, HiveReport* report, ReplyBuffer* reply) {
+    WordList* dictionaryList = server->dictionaryList;
+    char command[16];
+    char input[100];
+    char reqInp[100];
+    char word[100];
+    int fields = sscanf(line, "%15s %99s %99s %99s", command, input, reqInp, word);
+    reply->len = 0;
+
+    if (fields >= 1 && strcmp(command, "quit") == 0) {
+        replyPrintf(reply, "OK bye\n");
+        return true;
+    }
+    if (fields >= 1 && strcmp(command, "random") == 0) {
+        int hiveSize = (fields >= 2) ? atoi(input) : 0;
+        if (hiveSize < MIN_HIVE_SIZE || hiveSize > MAX_HIVE_SIZE) {
+            replyPrintf(reply, "ERR hive size must be %d..%d\n", MIN_HIVE_SIZE, MAX_HIVE_SIZE);
+            return false;
+        }
+        int chosenFitWord = pickFitWord(server->buckets, hiveSize);
+        if (chosenFitWord == -1) {
+            replyPrintf(reply, "ERR no words with %d unique letters\n", hiveSize);
+            return false;
+        }
+        char hive[MAX_HIVE_SIZE + 1];
+        buildHive(dictionaryList->words[chosenFitWord], hive);
+        replyPrintf(reply, "OK %s %c\n", hive, hive[rand() % hiveSize]);
+        return false;
+    }
+
+    bool needsWord = (fields >= 1 && strcmp(command, "valid") == 0);
+    if (fields < 1 || (strcmp(command, "solve") != 0 && strcmp(command, "stats") != 0 && !needsWord)) {
+        replyPrintf(reply, "ERR unknown command\n");
+        return false;
+    }
+    if (fields < (needsWord ? 4 : 3)) {
+        replyPrintf(reply, "ERR missing arguments\n");
+        return false;
+    }
+    BatchJob job;
+    parseBatchJob(input, reqInp, &job);
+    if (!job.valid) {
+        replyPrintf(reply, "ERR invalid hive\n");
+        return false;
+    }
+
+    if (strcmp(command, "solve") == 0) {
+        clearWordList(solvedList);
+        HiveStats stats;
+        cachedSolve(server->cache, dictionaryList, solvedList, report, job.hive, job.reqLet, &stats);
+        replyPrintf(reply, "OK %d %d", stats.numValidWords, stats.totScore);
+        for (int i = 0; i < solvedList->numWords; i++) {
+            replyPrintf(reply, " %s", solvedList->words[i]);
+        }
+        replyPrintf(reply, "\n");
+    }
+    else if (strcmp(command, "stats") == 0) {
+        HiveStats stats = queryHiveStats(server->maskStats, letterMask(job.hive), job.reqLet);
+        replyPrintf(reply, "OK words=%d pangrams=%d perfect=%d score=%d bingo=%s longest=%d\n",
+                    stats.numValidWords, stats.numPangrams, stats.numPerfectPangrams, stats.totScore, stats.isBingo ? "yes" : "no", stats.longestWord);
+    }
+    else {
+        for (int i = 0; word[i] != '\0'; i++) {
+            word[i] = tolower(word[i]);
+        }
+        int length = strlen(word);
+        unsigned int hiveMask = letterMask(job.hive);
+        unsigned int mask = letterMask(word);
+        if (length < MIN_WORD_LENGTH || (mask & ~hiveMask) != 0 || (mask & (1u << (job.reqLet - 'a'))) == 0 || !containsWord(dictionaryList, word)) {
+            replyPrintf(reply, "OK no\n");
+            return false;
+        }
+        int score = (length == 4) ? 1 : length;
+        if (mask == hiveMask) {
+            score += strlen(job.hive);
+        }
+        replyPrintf(reply, "OK yes %d\n", score);
+    }
+    return false;
+}
+
+/*
+purpose: daemon worker: take connections off the ready queue and answer their
+complete lines until none are left; quits when the server is stopping
+parameters: arg (SolverServer*)
+returns: NULL
+*/
+void* serverWorker(void* arg) {
+    SolverServer* server = arg;
+    WordList* solvedList = createWordList();
+    HiveReport* report = createHiveReport();
+    ReplyBuffer reply = {malloc(4096), 0, 4096};
+    char line[SERVER_MAX_LINE];
+
+    while (true) {
+        pthread_mutex_lock(&server->queueLock);
+        while (server->readyHead == NULL && !server->stopping) {
+            pthread_cond_wait(&server->queueReady, &server->queueLock);
+        }
+        ServerConn* conn = server->readyHead;
+        if (conn == NULL) {
+            pthread_mutex_unlock(&server->queueLock);
+            break;
+        }
+        server->readyHead = conn->nextReady;
+        if (server->readyHead == NULL) {
+            server->readyTail = NULL;
+        }
+        pthread_mutex_unlock(&server->queueLock);
+
+        while (true) {
+            pthread_mutex_lock(&conn->lock);
+            char* newline = memchr(conn->inBuf, '\n', conn->inLen);
+            if (newline == NULL) {
+                conn->busy = false;
+                bool closed = conn->closed;
+                pthread_mutex_unlock(&conn->lock);
+                if (closed) {
+                    close(conn->fd);
+                    pthread_mutex_destroy(&conn->lock);
+                    free(conn);
+                }
+                break;
+            }
+            int lineLen = newline - conn->inBuf;
+            memcpy(line, conn->inBuf, lineLen);
+            line[lineLen] = '\0';
+            conn->inLen -= lineLen + 1;
+            memmove(conn->inBuf, newline + 1, conn->inLen);
+            pthread_mutex_unlock(&conn->lock);
+
+            if (lineLen > 0 && line[lineLen - 1] == '\r') {
+                line[lineLen - 1] = '\0';
+            }
+            bool quit = handleServerRequest(server, line, solvedList, report, &reply);
+            bool sent = sendAll(conn->fd, reply.text, reply.len);
+            if (quit || !sent) {
+                // the event loop sees the hang-up and retires the connection
+                pthread_mutex_lock(&conn->lock);
+                conn->inLen = 0;
+                pthread_mutex_unlock(&conn->lock);
+                shutdown(conn->fd, SHUT_RDWR);
+            }
+        }
+    }
+
+    free(reply.text);
+    freeHiveReport(report);
+    freeWordList(solvedList);
+    return NULL;
+}
+
+/*
+purpose: hand a connection with a complete line to the workers (unless one has it already)
+parameters: server, conn (its lock must be held)
+returns: nothing
+*/
+void queueServerConn(SolverServer* server, ServerConn* conn) {
+    if (conn->busy || memchr(conn->inBuf, '\n', conn->inLen) == NULL) {
+        return;
+    }
+    conn->busy = true;
+    conn->nextReady = NULL;
+    pthread_mutex_lock(&server->queueLock);
+    if (server->readyTail == NULL) {
+        server->readyHead = conn;
+    }
+    else {
+        server->readyTail->nextReady = conn;
+    }
+    server->readyTail = conn;
+    pthread_cond_signal(&server->queueReady);
+    pthread_mutex_unlock(&server->queueLock);
+}
+
+/*
+purpose: daemon mode: build the indexes once, then serve the line protocol of
+handleServerRequest on a Unix domain socket; one epoll loop reads every
+client and a pool of numThreads workers answers; runs until SIGINT/SIGTERM
+parameters: dictionaryList, socketPath, numThreads
+returns: true on a clean shutdown, false if the socket could not be set up
+*/
+bool runServer(WordList* dictionaryList, char* socketPath, int numThreads, SolveCache* cache) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(socketPath) >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    strcpy(addr.sun_path, socketPath);
+
+    int listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd == -1) {
+        return false;
+    }
+    // a stale socket from an earlier run is replaced; anything else is left alone
+    struct stat existing;
+    if (lstat(socketPath, &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            printf("  ERROR %s exists and is not a socket\n", socketPath);
+            close(listenFd);
+            return false;
         }
+        unlink(socketPath);
     }
+    if (bind(listenFd, (struct sockaddr*)&addr, sizeof(addr)) == -1 || listen(listenFd, SOMAXCONN) == -1) {
+        close(listenFd);
+        return false;
+    }
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = NULL; // NULL marks the listening socket
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
 
-    int mdInd = (hiInd + loInd) / 2;
-
-    if (strcmp(aWord, thisWordList->words[mdInd]) == 0) { // Base case 1: found tryWord at midInd
-        return mdInd;
+    // everything the workers read is built here, before they start
+    SolverServer server;
+    server.dictionaryList = dictionaryList;
+    if (dictionaryList->maskIndex == NULL) {
+        dictionaryList->maskIndex = buildMaskIndex(dictionaryList);
     }
-    else if (strcmp(aWord, thisWordList->words[mdInd]) > 0) { // Recursive case: search upper half
-        return findWord(thisWordList, aWord, mdInd + 1, hiInd);
+    containsWord(dictionaryList, ""); // builds the hash set
+    server.maskStats = buildMaskStats(dictionaryList, dictionaryList->maskIndex);
+    server.cache = cache;
+    server.buckets = buildUniqueBuckets(dictionaryList);
+    pthread_mutex_init(&server.queueLock, NULL);
+    pthread_cond_init(&server.queueReady, NULL);
+    server.readyHead = NULL;
+    server.readyTail = NULL;
+    server.stopping = false;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = requestServerStop; // no SA_RESTART: epoll_wait returns EINTR
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    if (numThreads < 1) {
+        numThreads = 1;
     }
-    // Recursive case: search lower half
-    else {
-        return findWord(thisWordList, aWord, loInd, mdInd - 1);
+    pthread_t* threads = malloc(numThreads * sizeof(pthread_t));
+    for (int t = 0; t < numThreads; t++) {
+        pthread_create(&threads[t], NULL, serverWorker, &server);
     }
-}
+    printf("  Serving %s with %d workers (Ctrl-C to stop)\n", socketPath, numThreads);
+    fflush(stdout);
 
-/*
-purpose: optimized search that walks the hive-space like a tree, using 
-binary search to prune 
-parameters: dictionaryList, solvedList, tryWord, hive, reqlet
-returns: nothing
-*/void findAllMatches(WordList* dictionaryList, WordList* solvedList, char* tryWord, char* hive, char reqLet) {
-    // check if tryWord is exact word in dictionary
-    int curLen = strlen(tryWord);
-    int index = findWord(dictionaryList, tryWord, 0, dictionaryList->numWords - 1);
-    if (index >= 0) {
-        // if length is ok and passes hive rules, add if not already present
-        if (curLen >= MIN_WORD_LENGTH && isValidWord(tryWord, hive, reqLet)) {
-            bool alreadySeen = false;
-            for (int i = 0; i < solvedList->numWords; i++) {
-                if (strcmp(solvedList->words[i], tryWord) == 0) {
-                    alreadySeen = true;
-                    break;
+    // open connections by fd, so the ones still open can be freed at shutdown
+    int connCap = 64;
+    ServerConn** conns = calloc(connCap, sizeof(ServerConn*));
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    while (!serverStopRequested) {
+        int numEvents = epoll_wait(epollFd, events, SERVER_MAX_EVENTS, -1);
+        for (int e = 0; e < numEvents; e++) {
+            ServerConn* conn = events[e].data.ptr;
+            if (conn == NULL) {
+                int fd;
+                while ((fd = accept(listenFd, NULL, NULL)) != -1) {
+                    fcntl(fd, F_SETFL, O_NONBLOCK);
+                    conn = malloc(sizeof(ServerConn));
+                    conn->fd = fd;
+                    pthread_mutex_init(&conn->lock, NULL);
+                    conn->inLen = 0;
+                    conn->busy = false;
+                    conn->closed = false;
+                    if (fd >= connCap) {
+                        int newCap = connCap;
+                        while (fd >= newCap) {
+                            newCap *= 2;
+                        }
+                        conns = realloc(conns, newCap * sizeof(ServerConn*));
+                        memset(conns + connCap, 0, (newCap - connCap) * sizeof(ServerConn*));
+                        connCap = newCap;
+                    }
+                    conns[fd] = conn;
+                    event.events = EPOLLIN | EPOLLRDHUP;
+                    event.data.ptr = conn;
+                    epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
                 }
+                continue;
             }
-            if (!alreadySeen) {
-                appendWord(solvedList, tryWord);
-            }
-        }
-        // after a hit, extend by first hive letter 
-        tryWord[curLen] = hive[0];
-        tryWord[curLen + 1] = '\0';
-        if (tryWord[0] != '\0') {
-            findAllMatches(dictionaryList, solvedList, tryWord, hive, reqLet);
-        }
-        return;
-    }
-    if (index == -1) {
-        // extend by first hive letter and keep going
-        tryWord[curLen] = hive[0];
-        tryWord[curLen + 1] = '\0';
-        if (tryWord[0] != '\0') {
-            findAllMatches(dictionaryList, solvedList, tryWord, hive, reqLet);
-        }
-        return;
-    }
-    else if (index == -99) {
-        // no match on this branch
-        if (curLen == 0) {
-            return;
-        }
-        int position = findLetter(hive, tryWord[curLen - 1]);
 
-        if (position != -1 && position < strlen(hive) - 1) {
-            tryWord[curLen - 1] = hive[position + 1];
-        }
-        else {
-            tryWord[curLen - 1] = '\0';
-            // go back until we can advance the last letter 
-            while (tryWord[0] != '\0') {
-                int p = findLetter(hive, tryWord[strlen(tryWord) - 1]);
-                if (p != -1 && p < strlen(hive) - 1) {
-                    tryWord[strlen(tryWord) - 1] = hive[p + 1];
-                    break;
+            // read what fits; a full buffer without a newline is a bad client
+            pthread_mutex_lock(&conn->lock);
+            bool hangUp = false;
+            while (true) {
+                if (conn->inLen == SERVER_MAX_LINE) {
+                    if (memchr(conn->inBuf, '\n', conn->inLen) == NULL) {
+                        hangUp = true;
+                    }
+                    break; // the rest is read once a worker has made room
+                }
+                ssize_t n = read(conn->fd, conn->inBuf + conn->inLen, SERVER_MAX_LINE - conn->inLen);
+                if (n > 0) {
+                    conn->inLen += n;
+                    continue;
+                }
+                if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                    hangUp = true;
+                }
+                if (n == -1 && errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            // on end of input the lines already complete are still answered
+            queueServerConn(&server, conn);
+            if (hangUp) {
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, conn->fd, NULL);
+                conns[conn->fd] = NULL;
+                if (conn->busy) {
+                    conn->closed = true; // the worker closes it when done
+                    pthread_mutex_unlock(&conn->lock);
+                }
+                else {
+                    pthread_mutex_unlock(&conn->lock);
+                    close(conn->fd);
+                    pthread_mutex_destroy(&conn->lock);
+                    free(conn);
                 }
-                tryWord[strlen(tryWord) - 1] = '\0';
+            }
+            else {
+                pthread_mutex_unlock(&conn->lock);
             }
         }
     }
 
-    //call recursive function here ONLY if we still have a partial word left 
-    if (tryWord[0] != '\0') {
-        findAllMatches(dictionaryList, solvedList, tryWord, hive, reqLet);
+    printf("  Shutting down...\n");
+    pthread_mutex_lock(&server.queueLock);
+    server.stopping = true;
+    pthread_cond_broadcast(&server.queueReady);
+    pthread_mutex_unlock(&server.queueLock);
+    for (int t = 0; t < numThreads; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    for (int fd = 0; fd < connCap; fd++) {
+        if (conns[fd] != NULL) {
+            close(fd);
+            pthread_mutex_destroy(&conns[fd]->lock);
+            free(conns[fd]);
+        }
     }
+    free(conns);
+    free(threads);
+    close(epollFd);
+    close(listenFd);
+    unlink(socketPath);
+    pthread_mutex_destroy(&server.queueLock);
+    pthread_cond_destroy(&server.queueReady);
+    freeUniqueBuckets(server.buckets);
+    freeMaskStats(server.maskStats);
+    return true;
+}
+
+// settings for the tool modes that sit next to the game (solver engine,
+// compile, batch, enumeration); grouped so setSettings does not grow a parameter per flag
+typedef struct ToolSettings_struct {
+    bool indexMode; // -x: solve with the letter-set index
+    bool bitmapMode; // -m: solve with the per-letter bitmaps
+    bool walkMode; // -a: solve with the range-narrowing walk over the sorted dictionary
+    char compileFile[100]; // -c: write a compiled dictionary here ("" = off)
+    char batchFile[100]; // -b: solve every hive in this file ("" = off)
+    int enumSize; // -e: list stats for every hive of this size (0 = off)
+    int minWords; // --min-words: random hive needs at least this many words
+    int maxWords; // --max-words: ... and at most this many (-1 = no limit)
+    int minScore; // --min-score: ... and at least this total score
+    int numThreads; // -j: worker threads for brute force, batch and enumeration (0 = auto)
+    int statsFormat; // --stats[=json]: report phase times and counters (STATS_*)
+    char serveSocket[100]; // --serve: answer queries on this Unix socket ("" = off)
+    int outputFormat; // --format=text|jsonl|csv for results (FORMAT_*)
+    char ingestFile[100]; // -i: build the dictionary from this raw corpus instead ("" = off)
+    char cacheFile[100]; // --cache: keep solved hives in this file across runs ("" = off)
+    bool verifyImage; // --verify: checksum a compiled dictionary in full before using it
+    int queryMinLength; // --min-length: only words at least this long (0 = off)
+    int queryMaxLength; // --max-length: ... and at most this long (-1 = off)
+    bool queryPangrams; // --pangrams: only pangrams
+    char queryStart; // --starts: only words starting with this letter ('\0' = off)
+    char queryWith[27]; // --with: letters every word must use besides reqLet ("" = off)
+} ToolSettings;
+
+/*
+purpose: check if any word constraint flag was given (the solve then goes
+through the query planner)
+parameters: pTools
+returns: true if there is at least one constraint
+*/
+bool hasWordConstraints(ToolSettings* pTools) {
+    return pTools->queryMinLength > 0 || pTools->queryMaxLength >= 0 || pTools->queryPangrams || pTools->queryStart != '\0' || pTools->queryWith[0] != '\0';
 }
 
 /*
@@ -434,17 +4710,55 @@ returns: true if args ok, false otherwise
 flags: 
     -r <num> random hive of size num 
     -d <file> dictionary file 
+    -i <file> raw corpus to normalize into the dictionary instead ("-" = stdin,
+        which then cannot also supply the hive: needs -r, -b, -e, -c or --serve)
     -s <seed> set srand seed 
     -p play mode 
     -o optimized solver  
+    -x letter-set index solver
+    -m per-letter bitmap solver
+    -a sorted-array prefix walk solver
+    -c <file> compile the dictionary into a binary image and quit
+    -b <file> batch mode: solve every "hive reqLetter" line of file
+    -e <num> enumerate every hive of size num that has a pangram
+    --min-words <num>, --max-words <num>, --min-score <num> constraints for -r
+    -j <num> worker threads (brute force solver, batch, enumeration)
+    --stats, --stats=json report phase timers and counters at the end
+    --serve <socket> run as a daemon answering queries on a Unix domain socket
+    --format=text|jsonl|csv results format; for jsonl/csv the other text goes to stderr
+    --cache <file> reuse solved hives stored in file by earlier runs (and add to it)
+    --verify check a compiled dictionary's checksum over the whole image on load
+    --min-length <num>, --max-length <num>, --pangrams, --starts <letter>, --with <letters>
+        constraints on the solved words (answered by the query planner)
 */
-bool setSettings(int argc, char* argv[], bool* pRandMode, int* pNumLets, char dictFile[100], bool* pPlayMode, bool* pBruteForceMode, bool* pSeedSelection) {
+bool setSettings(int argc, char* argv[], bool* pRandMode, int* pNumLets, char dictFile[100], bool* pPlayMode, bool* pBruteForceMode, bool* pSeedSelection, ToolSettings* pTools) {
     *pRandMode = false;
     *pNumLets = 0;
     strcpy(dictFile, "dictionary.txt");
     *pPlayMode = false;
     *pBruteForceMode = true;
     *pSeedSelection = false;
+    pTools->indexMode = false;
+    pTools->bitmapMode = false;
+    pTools->walkMode = false;
+    pTools->compileFile[0] = '\0';
+    pTools->batchFile[0] = '\0';
+    pTools->enumSize = 0;
+    pTools->minWords = 0;
+    pTools->maxWords = -1;
+    pTools->minScore = 0;
+    pTools->numThreads = 0;
+    pTools->statsFormat = STATS_OFF;
+    pTools->serveSocket[0] = '\0';
+    pTools->outputFormat = FORMAT_TEXT;
+    pTools->ingestFile[0] = '\0';
+    pTools->cacheFile[0] = '\0';
+    pTools->verifyImage = false;
+    pTools->queryMinLength = 0;
+    pTools->queryMaxLength = -1;
+    pTools->queryPangrams = false;
+    pTools->queryStart = '\0';
+    pTools->queryWith[0] = '\0';
     srand((int)time(0));
     //--------------------------------------
     for (int i = 1; i < argc; ++i) {
@@ -486,10 +4800,159 @@ bool setSettings(int argc, char* argv[], bool* pRandMode, int* pNumLets, char di
         else if (strcmp(argv[i], "-o") == 0) {
             *pBruteForceMode = false;
         }
+        else if (strcmp(argv[i], "-x") == 0) {
+            pTools->indexMode = true;
+        }
+        else if (strcmp(argv[i], "-m") == 0) {
+            pTools->bitmapMode = true;
+        }
+        else if (strcmp(argv[i], "-a") == 0) {
+            *pBruteForceMode = false;
+            pTools->walkMode = true;
+        }
+        else if (strcmp(argv[i], "-c") == 0) {
+            ++i;
+            if (argc == i || strlen(argv[i]) >= 100) {
+                return false;
+            }
+            strcpy(pTools->compileFile, argv[i]);
+        }
+        else if (strcmp(argv[i], "-b") == 0) {
+            ++i;
+            if (argc == i || strlen(argv[i]) >= 100) {
+                return false;
+            }
+            strcpy(pTools->batchFile, argv[i]);
+        }
+        else if (strcmp(argv[i], "-e") == 0) {
+            ++i;
+            if (argc == i) {
+                return false;
+            }
+            pTools->enumSize = atoi(argv[i]);
+            if (pTools->enumSize < MIN_HIVE_SIZE || pTools->enumSize > MAX_HIVE_SIZE) {
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "-j") == 0) {
+            ++i;
+            if (argc == i) {
+                return false;
+            }
+            pTools->numThreads = atoi(argv[i]);
+            if (pTools->numThreads < 1) {
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "-i") == 0) {
+            ++i;
+            if (argc == i || strlen(argv[i]) >= 100) {
+                return false;
+            }
+            strcpy(pTools->ingestFile, argv[i]);
+        }
+        else if (strcmp(argv[i], "--serve") == 0) {
+            ++i;
+            if (argc == i || strlen(argv[i]) >= 100) {
+                return false;
+            }
+            strcpy(pTools->serveSocket, argv[i]);
+        }
+        else if (strcmp(argv[i], "--cache") == 0) {
+            ++i;
+            if (argc == i || strlen(argv[i]) >= 100) {
+                return false;
+            }
+            strcpy(pTools->cacheFile, argv[i]);
+        }
+        else if (strcmp(argv[i], "--min-length") == 0 || strcmp(argv[i], "--max-length") == 0) {
+            ++i;
+            if (argc == i) {
+                return false;
+            }
+            int value = atoi(argv[i]);
+            if (value < 1) {
+                return false;
+            }
+            if (strcmp(argv[i - 1], "--min-length") == 0) {
+                pTools->queryMinLength = value;
+            }
+            else {
+                pTools->queryMaxLength = value;
+            }
+        }
+        else if (strcmp(argv[i], "--verify") == 0) {
+            pTools->verifyImage = true;
+        }
+        else if (strcmp(argv[i], "--pangrams") == 0) {
+            pTools->queryPangrams = true;
+        }
+        else if (strcmp(argv[i], "--starts") == 0) {
+            ++i;
+            if (argc == i || strlen(argv[i]) != 1 || argv[i][0] < 'a' || argv[i][0] > 'z') {
+                return false;
+            }
+            pTools->queryStart = argv[i][0];
+        }
+        else if (strcmp(argv[i], "--with") == 0) {
+            ++i;
+            if (argc == i || strlen(argv[i]) > 26) {
+                return false;
+            }
+            for (int k = 0; argv[i][k] != '\0'; k++) {
+                if (argv[i][k] < 'a' || argv[i][k] > 'z') {
+                    return false;
+                }
+            }
+            strcpy(pTools->queryWith, argv[i]);
+        }
+        else if (strncmp(argv[i], "--format=", 9) == 0) {
+            if (strcmp(argv[i] + 9, "text") == 0) {
+                pTools->outputFormat = FORMAT_TEXT;
+            }
+            else if (strcmp(argv[i] + 9, "jsonl") == 0) {
+                pTools->outputFormat = FORMAT_JSONL;
+            }
+            else if (strcmp(argv[i] + 9, "csv") == 0) {
+                pTools->outputFormat = FORMAT_CSV;
+            }
+            else {
+                return false;
+            }
+        }
+        else if (strcmp(argv[i], "--stats") == 0) {
+            pTools->statsFormat = STATS_TEXT;
+        }
+        else if (strcmp(argv[i], "--stats=json") == 0) {
+            pTools->statsFormat = STATS_JSON;
+        }
+        else if (strcmp(argv[i], "--min-words") == 0 || strcmp(argv[i], "--max-words") == 0 || strcmp(argv[i], "--min-score") == 0) {
+            ++i;
+            if (argc == i) {
+                return false;
+            }
+            int value = atoi(argv[i]);
+            if (value < 0) {
+                return false;
+            }
+            if (strcmp(argv[i - 1], "--min-words") == 0) {
+                pTools->minWords = value;
+            }
+            else if (strcmp(argv[i - 1], "--max-words") == 0) {
+                pTools->maxWords = value;
+            }
+            else {
+                pTools->minScore = value;
+            }
+        }
         else {
             return false;
         }
     }
+    // a corpus read from stdin leaves nothing there for entering the hive
+    if (strcmp(pTools->ingestFile, "-") == 0 && !*pRandMode && pTools->batchFile[0] == '\0' && pTools->enumSize == 0 && pTools->serveSocket[0] == '\0' && pTools->compileFile[0] == '\0') {
+        return false;
+    }
     return true;
 }
 
@@ -525,6 +4988,9 @@ parameters: standard argc/argv
 returns: 0 on sucess, nonzero on early error 
 */
 int main(int argc, char* argv[]) {
+    runStats.phase = PHASE_SETTINGS;
+    runStats.phaseWallStart = readClock(CLOCK_MONOTONIC);
+    runStats.phaseCpuStart = readClock(CLOCK_PROCESS_CPUTIME_ID);
 
     printf("\n----- Welcome to the CS 211 Spelling Bee Game & Solver! -----\n\n");
 
@@ -535,17 +5001,26 @@ int main(int argc, char* argv[]) {
     bool playMode = false;
     bool bruteForce = true;
     bool seedSelection = false;
-    char hive[MAX_HIVE_SIZE + 1] = {};
+    ToolSettings tools;
+    char hive[MAX_HIVE_SIZE + 1];
     hive[0] = '\0';
     int reqLetInd = -1;
     char reqLet = '\0';
 
     // read command-line arguments using setSettings
-    if (!setSettings(argc, argv, &randMode, &hiveSize, dict, &playMode, &bruteForce, &seedSelection)) {
+    if (!setSettings(argc, argv, &randMode, &hiveSize, dict, &playMode, &bruteForce, &seedSelection, &tools)) {
         printf("Invalid command-line argument(s).\nTerminating program...\n");
         return 1;
     }
     else {
+        runStats.enabled = (tools.statsFormat != STATS_OFF);
+        outWriter.format = tools.outputFormat;
+        if (tools.outputFormat != FORMAT_TEXT) {
+            // results keep stdout to themselves; everything printf'd (including
+            // the banner still in the stdio buffer) moves to stderr
+            outWriter.fd = dup(STDOUT_FILENO);
+            dup2(STDERR_FILENO, STDOUT_FILENO);
+        }
         // print the chosen setting
         printf("Program Settings:\n");
         printf("  random mode = ");
@@ -554,16 +5029,88 @@ int main(int argc, char* argv[]) {
         printONorOFF(playMode);
         printf("  brute force solution = ");
         printONorOFF(bruteForce);
-        printf("  dictionary file = %s\n", dict);
+        printf("  index solution = ");
+        printONorOFF(tools.indexMode);
+        printf("  bitmap solution = ");
+        printONorOFF(tools.bitmapMode);
+        printf("  prefix walk solution = ");
+        printONorOFF(tools.walkMode);
+        if (tools.ingestFile[0] != '\0') {
+            printf("  corpus file = %s\n", tools.ingestFile);
+        }
+        else {
+            printf("  dictionary file = %s\n", dict);
+        }
+        if (tools.compileFile[0] != '\0') {
+            printf("  compile to = %s\n", tools.compileFile);
+        }
+        if (tools.batchFile[0] != '\0') {
+            printf("  batch file = %s\n", tools.batchFile);
+        }
+        if (tools.enumSize != 0) {
+            printf("  enumerate hive size = %d\n", tools.enumSize);
+        }
+        if (tools.serveSocket[0] != '\0') {
+            printf("  serve socket = %s\n", tools.serveSocket);
+        }
+        if (tools.cacheFile[0] != '\0') {
+            printf("  cache file = %s\n", tools.cacheFile);
+        }
+        if (hasWordConstraints(&tools)) {
+            printf("  word constraints = length %d..", (tools.queryMinLength > MIN_WORD_LENGTH) ? tools.queryMinLength : MIN_WORD_LENGTH);
+            if (tools.queryMaxLength >= 0) {
+                printf("%d", tools.queryMaxLength);
+            }
+            printf("%s", tools.queryPangrams ? ", pangrams only" : "");
+            if (tools.queryStart != '\0') {
+                printf(", starts with %c", tools.queryStart);
+            }
+            if (tools.queryWith[0] != '\0') {
+                printf(", with %s", tools.queryWith);
+            }
+            printf("\n");
+        }
+        if (tools.numThreads != 0) {
+            printf("  threads = %d\n", tools.numThreads);
+        }
+        if (tools.outputFormat != FORMAT_TEXT) {
+            printf("  output format = %s\n", (tools.outputFormat == FORMAT_JSONL) ? "jsonl" : "csv");
+        }
+        if (tools.statsFormat != STATS_OFF) {
+            printf("  stats = %s\n", (tools.statsFormat == STATS_JSON) ? "json" : "text");
+        }
+        if (tools.minWords > 0 || tools.maxWords >= 0 || tools.minScore > 0) {
+            printf("  random hive constraints = words %d..", tools.minWords);
+            if (tools.maxWords >= 0) {
+                printf("%d", tools.maxWords);
+            }
+            printf(", score >= %d\n", tools.minScore);
+        }
         printf("  hive set = ");
         printYESorNO(randMode);
         printf("\n\n");
     }
 
     // build word array (only words with desired minimum length or longer) from dictionary file
+    enterPhase(PHASE_DICTIONARY);
     printf("Building array of words from dictionary... \n");
     WordList* dictionaryList = createWordList();
-    int maxWordLength = buildDictionary(dict, dictionaryList, MIN_WORD_LENGTH);
+    int maxWordLength;
+    if (tools.ingestFile[0] != '\0') {
+        int numThreads = (tools.numThreads != 0) ? tools.numThreads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        maxWordLength = ingestCorpus(tools.ingestFile, dictionaryList, MIN_WORD_LENGTH, numThreads);
+        strcpy(dict, tools.ingestFile);
+    }
+    else {
+        maxWordLength = buildDictionary(dict, dictionaryList, MIN_WORD_LENGTH, tools.verifyImage);
+        if (maxWordLength != -1) {
+            int numThreads = (tools.numThreads != 0) ? tools.numThreads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+            int numDuplicates = sortWordList(dictionaryList, numThreads);
+            if (numDuplicates != -1) {
+                printf("   Word array sorted (%d duplicates removed)\n", numDuplicates);
+            }
+        }
+    }
     if (maxWordLength == -1) {
         printf("  ERROR in building word array.\n");
         printf("  File not found or incorrect number of valid words.\n");
@@ -591,22 +5138,145 @@ int main(int argc, char* argv[]) {
         printf("  Dictionary %s contains \n  %d words of length %d or more;\n", dict, dictionaryList->numWords, MIN_WORD_LENGTH);
     }
 
+    if (tools.compileFile[0] != '\0') {
+        enterPhase(PHASE_SOLVE);
+        printf("==== COMPILE DICTIONARY ====\n");
+        // loading already sorted the words and dropped duplicates
+        WordList* sortedList = buildCompactDictionary(dictionaryList);
+        sortedList->maskIndex = buildMaskIndex(sortedList);
+        sortedList->trie = buildTrie(sortedList);
+        bool written = writeCompiledDictionary(tools.compileFile, sortedList, maxWordLength, MIN_WORD_LENGTH);
+        if (written) {
+            printf("  Wrote %d sorted words to %s\n\n", sortedList->numWords, tools.compileFile);
+        }
+        else {
+            printf("  ERROR writing %s\n", tools.compileFile);
+        }
+        freeWordList(sortedList);
+        freeWordList(dictionaryList);
+        if (tools.statsFormat != STATS_OFF) {
+            printRunStats(tools.statsFormat);
+        }
+        return written ? 0 : -1;
+    }
+
+    // the -m bitmaps are built once here; batch, server and the solver share them
+    if (tools.bitmapMode) {
+        dictionaryList->bitmaps = buildLetterBitmaps(dictionaryList);
+    }
+
+    if (tools.batchFile[0] != '\0') {
+        enterPhase(PHASE_SOLVE);
+        printf("==== BATCH MODE ====\n");
+        int numThreads = (tools.numThreads != 0) ? tools.numThreads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        bool solved = runBatch(dictionaryList, tools.batchFile, numThreads);
+        if (!solved) {
+            printf("  ERROR reading batch file %s\n", tools.batchFile);
+        }
+        freeWordList(dictionaryList);
+        freeOutputWriter();
+        printf("\n\n");
+        if (tools.statsFormat != STATS_OFF) {
+            printRunStats(tools.statsFormat);
+        }
+        return solved ? 0 : -1;
+    }
+
+    if (tools.serveSocket[0] != '\0') {
+        enterPhase(PHASE_SOLVE);
+        printf("==== SERVER MODE ====\n");
+        int numThreads = (tools.numThreads != 0) ? tools.numThreads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        // the daemon always keeps recent hives in memory; --cache adds the file
+        SolveCache* cache = openSolveCache((tools.cacheFile[0] != '\0') ? tools.cacheFile : NULL, dictionaryList, MIN_WORD_LENGTH);
+        bool served = false;
+        if (cache == NULL) {
+            printf("  ERROR opening cache file %s\n", tools.cacheFile);
+        }
+        else {
+            served = runServer(dictionaryList, tools.serveSocket, numThreads, cache);
+            if (!served) {
+                printf("  ERROR listening on %s\n", tools.serveSocket);
+            }
+        }
+        closeSolveCache(cache);
+        freeWordList(dictionaryList);
+        printf("\n\n");
+        if (tools.statsFormat != STATS_OFF) {
+            printRunStats(tools.statsFormat);
+        }
+        return served ? 0 : -1;
+    }
+
+    if (tools.enumSize != 0) {
+        enterPhase(PHASE_SOLVE);
+        printf("==== ENUMERATE HIVES ====\n");
+        int numThreads = (tools.numThreads != 0) ? tools.numThreads : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        runEnumeration(dictionaryList, tools.enumSize, numThreads);
+        freeWordList(dictionaryList);
+        freeOutputWriter();
+        printf("\n\n");
+        if (tools.statsFormat != STATS_OFF) {
+            printRunStats(tools.statsFormat);
+        }
+        return 0;
+    }
+
 
+    // the -o trie is part of loading, not of each solve (compiled images carry it)
+    if (!bruteForce && !tools.walkMode && !hasWordConstraints(&tools) && dictionaryList->trie == NULL) {
+        dictionaryList->trie = buildTrie(dictionaryList);
+    }
+
+    enterPhase(PHASE_HIVE);
+    MaskStatsTable* maskStats = NULL;
     if (randMode) {
         printf("==== SET HIVE: RANDOM MODE ====\n");
-        //find number of words in words array that use hiveSize unique letters
-        WordList* fitWords = findAllFitWords(dictionaryList, hiveSize);
-        int numFitWords = fitWords->numWords;
-        //pick one at random
-        int pickOne = rand() % numFitWords;
-        char* chosenFitWord = fitWords->words[pickOne];
+        // with constraints, per-letter-set totals make the stats of any hive a
+        // subset-sum lookup; without, the first draw is taken as is
+        bool constrained = tools.minWords > 0 || tools.minScore > 0 || tools.maxWords >= 0;
+        if (constrained) {
+            if (dictionaryList->maskIndex == NULL) {
+                dictionaryList->maskIndex = buildMaskIndex(dictionaryList);
+            }
+            maskStats = buildMaskStats(dictionaryList, dictionaryList->maskIndex);
+        }
+        UniqueBuckets* buckets = buildUniqueBuckets(dictionaryList);
+
+        // pick a fit word + required letter; redraw while the hive misses the constraints
+        bool found = false;
+        for (int attempt = 0; attempt < MAX_HIVE_ATTEMPTS && !found; attempt++) {
+            int chosenFitWord = pickFitWord(buckets, hiveSize);
+            if (chosenFitWord == -1) {
+                break;
+            }
+
+            //and alaphabetize the unique letters to make the letter hive
+            buildHive(dictionaryList->words[chosenFitWord], hive);
 
-        //and alaphabetize the unique letters to make the letter hive
-        buildHive(chosenFitWord, hive);
-        freeWordList(fitWords);
+            reqLetInd = rand() % hiveSize;
+            reqLet = hive[reqLetInd];
 
-        reqLetInd = rand() % hiveSize;
-        reqLet = hive[reqLetInd];
+            found = true;
+            if (constrained) {
+                HiveStats stats = queryHiveStats(maskStats, letterMask(hive), reqLet);
+                found = stats.numValidWords >= tools.minWords && stats.totScore >= tools.minScore
+                        && (tools.maxWords < 0 || stats.numValidWords <= tools.maxWords);
+            }
+        }
+        if (!found) {
+            if (buckets->starts[hiveSize + 1] == buckets->starts[hiveSize]) {
+                printf("  Dictionary has no words with %d unique letters.\n", hiveSize);
+            }
+            else {
+                printf("  No hive of %d letters meets the requested constraints.\n", hiveSize);
+            }
+            printf("Terminating program...\n");
+            freeUniqueBuckets(buckets);
+            freeMaskStats(maskStats);
+            freeWordList(dictionaryList);
+            return -1;
+        }
+        freeUniqueBuckets(buckets);
 
     }
     else {
@@ -616,7 +5286,13 @@ int main(int argc, char* argv[]) {
         char input[100];
 
         while (true) {
-            scanf("%s", input);
+            if (scanf("%99s", input) != 1) {
+                printf("\n  HIVE ERROR: input ended before a hive was entered\n");
+                printf("Terminating program...\n");
+                freeWordList(dictionaryList);
+                freeOutputWriter();
+                return -1;
+            }
             int length = strlen(input);
             bool validInput = true;
 
@@ -669,7 +5345,13 @@ int main(int argc, char* argv[]) {
         
         char reqInp[10];
         while (true) {
-            scanf("%s", reqInp);
+            if (scanf("%9s", reqInp) != 1) {
+                printf("\n  HIVE ERROR: input ended before the required letter was entered\n");
+                printf("Terminating program...\n");
+                freeWordList(dictionaryList);
+                freeOutputWriter();
+                return -1;
+            }
             char c = tolower(reqInp[0]);
             int index = findLetter(hive, c);
 
@@ -689,22 +5371,23 @@ int main(int argc, char* argv[]) {
     printHive(hive, reqLetInd);
 
     if (playMode) {
+        enterPhase(PHASE_PLAY);
         printf("==== PLAY MODE ====\n");
     //---------------------------------------------------------------------
     //              BEGINNING OF OPEN-ENDED GAMEPLAY SECTION
     //---------------------------------------------------------------------
 
-        char* userWord = (char*)malloc((maxWordLength + 1) * sizeof(char));
-        strcpy(userWord, "default");
-
-        WordList* userWordList = createWordList();
+        char userWord[100];
+        PlayGame* game = startPlayGame(dictionaryList, hive, reqLet);
 
         printf("............................................\n");
         printHive(hive, reqLetInd);
 
 
-        printf("  Enter a word (enter DONE to quit): ");
-        scanf("%s", userWord);
+        printf("  Enter a word (enter HINTS for the words left, DONE to quit): ");
+        if (scanf("%99s", userWord) != 1) {
+            strcpy(userWord, "DONE");
+        }
         printf("\n");
 
 
@@ -714,47 +5397,44 @@ int main(int argc, char* argv[]) {
                 break;
             }
 
-            for (int i = 0; userWord[i] != '\0'; i++) {
-                userWord[i] = tolower(userWord[i]);
+            if (strcmp(userWord, "HINTS") == 0 || strcmp(userWord, "hints") == 0) {
+                printf("  Words Left:\n");
+                printLetterGrid(game->remaining, game->report->stats.longestWord, hive);
             }
-            bool added = false;
-
-            if (strlen(userWord) >= MIN_WORD_LENGTH) {
-                int index = findWord(dictionaryList, userWord, 0, dictionaryList->numWords - 1);
-                bool insideDictionary = (index >= 0);
-
-                if (insideDictionary && isValidWord(userWord, hive, reqLet)) {
-                    bool already = false;
-                    for (int i = 0; i < userWordList->numWords; i++) {
-                        if (strcmp(userWordList->words[i], userWord) == 0) {
-                            already = true;
-                            break;
-                        }
-                    }
-                    if (!already) {
-                        appendWord(userWordList, userWord);
-                        added = true;
-                    }
+            else {
+                for (int i = 0; userWord[i] != '\0'; i++) {
+                    userWord[i] = tolower(userWord[i]);
+                }
+                int points = playGuess(game, userWord);
+                if (points == -1) {
+                    printf("  (invalid word)\n");
+                }
+                else if (points == -2) {
+                    printf("  (already found)\n");
+                }
+                else {
+                    printf("  \"%s\" +%d\n", userWord, points);
                 }
             }
-            if (!added) {
-                printf("  (invalid or duplicate)\n");
-            }
-            
-            //prints the list and the hive, and gets the next input
+
+            //prints the running totals and the hive, and gets the next input
             printf("\n");
-            printList(userWordList, hive);
+            printf("  Found %d of %d words, %d of %d pangrams\n", game->foundList->numWords, game->report->stats.numValidWords,
+                   game->numPangramsFound, game->report->stats.numPangrams);
+            printf("  Total Score: %d of %d\n", game->score, game->report->stats.totScore);
             printf("............................................\n");
             printHive(hive, reqLetInd);
 
-            printf("  Enter a word (enter DONE to quit): ");
-            scanf("%s", userWord);
+            printf("  Enter a word (enter HINTS for the words left, DONE to quit): ");
+            if (scanf("%99s", userWord) != 1) {
+                strcpy(userWord, "DONE");
+            }
             printf("\n");
 
         }
 
-        freeWordList(userWordList);
-        free(userWord);
+        printList(game->foundList, hive);
+        freePlayGame(game);
 
     //---------------------------------------------------------------------    
     //                 END OF OPEN-ENDED GAMEPLAY SECTION
@@ -763,6 +5443,7 @@ int main(int argc, char* argv[]) {
     
         
 
+    enterPhase(PHASE_SOLVE);
     printf("==== SPELLING BEE SOLVER ====\n");
 
     printf("  Valid words from hive \"%s\":\n", hive);
@@ -773,85 +5454,69 @@ int main(int argc, char* argv[]) {
     printf("^\n");
 
     WordList* solvedList = createWordList();
+    HiveReport* report = createHiveReport();
 
-    if (bruteForce) { //find all words that work... (1) brute force
-        bruteForceSolve(dictionaryList, solvedList, hive, reqLet);
+    // the mask engines all give the same list, so --cache stands in for them
+    SolveCache* cache = NULL;
+    bool queryMode = hasWordConstraints(&tools);
+    if (tools.cacheFile[0] != '\0' && !queryMode && (bruteForce || tools.indexMode || tools.bitmapMode)) {
+        cache = openSolveCache(tools.cacheFile, dictionaryList, MIN_WORD_LENGTH);
+        if (cache == NULL) {
+            printf("  ERROR opening cache file %s; solving without it\n", tools.cacheFile);
+        }
     }
-    else {
-        char* tryWord = (char*)malloc(sizeof(char) * (maxWordLength + 1));
-
-        tryWord[0] = hive[0];
-        tryWord[1] = '\0';
-        findAllMatches(dictionaryList, solvedList, tryWord, hive, reqLet);
-        free(tryWord);
-
+    if (tools.indexMode && dictionaryList->maskIndex == NULL) {
+        dictionaryList->maskIndex = buildMaskIndex(dictionaryList);
     }
 
-    int longestSolvedWordLen = 0;
-    for (int i = 0; i < solvedList->numWords; i++) {
-        if (strlen(solvedList->words[i]) > longestSolvedWordLen) {
-            longestSolvedWordLen = strlen(solvedList->words[i]);
-        }
+    if (queryMode) { //find all words that work... (000) constraint query, on the path the planner picks
+        WordQuery query;
+        query.allowedMask = letterMask(hive);
+        query.requiredMask = (1u << (reqLet - 'a')) | letterMask(tools.queryWith);
+        query.minLength = (tools.queryMinLength > MIN_WORD_LENGTH) ? tools.queryMinLength : MIN_WORD_LENGTH;
+        query.maxLength = tools.queryMaxLength;
+        query.pangramsOnly = tools.queryPangrams;
+        query.startLetter = tools.queryStart;
+        QueryPlan plan = planWordQuery(&query, dictionaryList);
+        printf("  query plan: %s (cost estimate %lld)\n", queryPathName(plan.path), plan.cost);
+        runWordQuery(&query, &plan, dictionaryList, solvedList);
     }
-
-    // Helpful variables
-    int numValidWords = 0;
-    int numPangrams = 0;
-    int numPerfectPangrams = 0;
-    int totScore = 0;
-    int score = 0;
-    bool isBingo = true;
-    
-    int hiveSizeLocal = strlen(hive);
-    int already[26] = {0};
-
-    for (int i = 0; i < solvedList->numWords; i++) {
-        char* w = solvedList->words[i];
-        int length = strlen(w);
-        int thisScore;
-        if (length == 4) {
-            thisScore = 1;
-        }
-        else {
-            thisScore = length;
-        }
-        bool pangram = isPangram(w, hive);
-        if (pangram){
-            thisScore += hiveSizeLocal;
-        }
-        bool perfect = ((pangram) && (length == hiveSizeLocal));
-
-        if (perfect) {
-            printf("  *** (%2d) %s\n", thisScore, w);
-            numPerfectPangrams++;
-            numPangrams++;
-        }
-        else if (pangram) {
-            printf("  * (%2d) %s\n", thisScore, w);
-            numPangrams++;
-        }
-        else {
-            printf("    (%2d) %s\n", thisScore, w);
-        }
-
-        numValidWords++;
-        totScore+= thisScore;
-
-        char cLow = tolower(w[0]);
-        if (cLow >= 'a' && cLow <= 'z' && findLetter(hive, cLow) != -1) {
-            already[cLow - 'a'] = 1;
-        }
+    else if (cache != NULL) { //find all words that work... (00) stored result, or an index/kernel solve once
+        HiveStats cachedStats; // the report below has the same totals
+        cachedSolve(cache, dictionaryList, solvedList, report, hive, reqLet, &cachedStats);
+        closeSolveCache(cache);
+    }
+    else if (tools.indexMode) { //find all words that work... (0) letter-set index
+        indexSolve(dictionaryList->maskIndex, dictionaryList, solvedList, hive, reqLet);
+    }
+    else if (tools.bitmapMode) { //find all words that work... (0b) per-letter bitmaps
+        bitmapSolve(dictionaryList->bitmaps, dictionaryList, solvedList, hive, reqLet);
+    }
+    else if (tools.walkMode) { //find all words that work... (1b) prefix ranges of the sorted dictionary
+        findAllMatches(dictionaryList, solvedList, hive, reqLet);
+    }
+    else if (bruteForce && tools.numThreads > 1) { //find all words that work... (1) brute force, split over -j threads
+        parallelBruteForceSolve(dictionaryList, solvedList, hive, reqLet, tools.numThreads);
+    }
+    else if (bruteForce) { //find all words that work... (1) brute force
+        bruteForceSolve(dictionaryList, solvedList, hive, reqLet);
+    }
+    else { //find all words that work... (2) trie walk over hive letters
+        trieSolve(dictionaryList->trie, dictionaryList, solvedList, hive, reqLet);
     }
 
-    isBingo = true;
+    // one pass for scores, pangrams, totals and the frequency grid
+    enterPhase(PHASE_AGGREGATE);
+    computeHiveReport(report, solvedList, hive);
+    HiveStats summary = report->stats;
 
-    for (int i = 0; i < hiveSizeLocal; i++) {
-        if (!already[hive[i] - 'a']) {
-            isBingo = false;
-            break;
-        }
+    enterPhase(PHASE_OUTPUT);
+    printSolvedWords(report, solvedList);
+    if (tools.outputFormat == FORMAT_JSONL) {
+        printStatsRow(hive, reqLet, &summary); // the totals as the last record
     }
-    
+    freeOutputWriter();
+
     // Additional results are printed here:
     printf("\n");
     printf("  Total counts for hive \"%s\":\n", hive);
@@ -860,43 +5525,23 @@ int main(int argc, char* argv[]) {
         printf(" ");
     }
     printf("^\n");
-    printf("    Number of Valid Words: %d\n", numValidWords);
-    printf("    Number of ( * ) Pangrams: %d\n", numPangrams);
-    printf("    Number of (***) Perfect Pangrams: %d\n", numPerfectPangrams);
+    printf("    Number of Valid Words: %d\n", summary.numValidWords);
+    printf("    Number of ( * ) Pangrams: %d\n", summary.numPangrams);
+    printf("    Number of (***) Perfect Pangrams: %d\n", summary.numPerfectPangrams);
     printf("    Bingo: ");
-    printYESorNO(isBingo);
-    printf("    Total Score Possible: %d\n", totScore);
-
-    printf("\n  Frequency Table:\n");
-    printf("        ");
-    for (int length = MIN_WORD_LENGTH; length <= longestSolvedWordLen; length++) {
-        printf("%3d", length);
-    }
-    printf("\n      ");
-    for (int length = MIN_WORD_LENGTH; length <= longestSolvedWordLen; length++) {
-        printf("---");
-    }
-    printf("\n");
+    printYESorNO(summary.isBingo);
+    printf("    Total Score Possible: %d\n", summary.totScore);
 
-    for (int i = 0; i < hiveSizeLocal; i++) {
-        char letter = hive[i];
-        printf("   %c", letter);
-        for (int len = MIN_WORD_LENGTH; len <= longestSolvedWordLen; len++) {
-            int count = 0;
-            for (int j = 0; j < solvedList->numWords; j++) {
-                char* word = solvedList->words[j];
-                if (tolower(word[0]) == letter && strlen(word) == len) {
-                    count++;
-                }
-            }
-            printf("%3d", count);
-        }
-        printf("\n");
-    }
+    printFrequencyTable(report, hive);
 
+    freeHiveReport(report);
+    freeMaskStats(maskStats);
     freeWordList(dictionaryList);
     freeWordList(solvedList);
     printf("\n\n");
+    if (tools.statsFormat != STATS_OFF) {
+        printRunStats(tools.statsFormat);
+    }
     return 0;
 }
 
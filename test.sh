@@ -0,0 +1,97 @@
+#!/bin/sh
+# test.sh - solver cross-check for spellingBee.exe
+#
+# Solves fixed hives with every engine, and "must include" queries through the
+# letter bitmaps, on a deterministic synthetic dictionary and checks each word
+# list against the brute-force solver. Exits nonzero if any of them differ.
+#
+# usage: ./test.sh [options]
+#   -b <exe>        binary to test (default ./spellingBee.exe)
+#   -n <size>       dictionary size in words (default 100000: a full bitmap
+#                   container plus a partial one, so sparse letters are arrays)
+
+EXE=./spellingBee.exe
+SIZE=100000
+LETTERS="eeeeeeeeeeeetttttttttaaaaaaaaooooooooiiiiiiinnnnnnnsssssshhhhhhrrrrrrddddllllcccuuummwwffggyyppbbvkjxqz"
+DATA_DIR=bench_data
+
+# hives ("hive reqLetter"), and the positions of the two hive letters each
+# --with query adds to the required one
+HIVES="etaoins_e abcdefg_a rstlnea_r qzxjkvb_q hmpcodu_o abeiorz_e"
+ENGINES="-o -x -m -a"
+PAIRS="1_7 2_7 3_5 4_6"
+
+while getopts "b:n:" opt; do
+    case $opt in
+        b) EXE=$OPTARG ;;
+        n) SIZE=$OPTARG ;;
+        *) sed -n '8,11p' "$0"; exit 2 ;;
+    esac
+done
+
+if [ ! -x "$EXE" ]; then
+    echo "test: $EXE not found (run make build first)"
+    exit 2
+fi
+mkdir -p "$DATA_DIR"
+
+# generateDictionary size file: the same generator as bench.sh, so both share
+# the files in $DATA_DIR
+generateDictionary() {
+    awk -v n="$1" -v letters="$LETTERS" 'BEGIN {
+        srand(211)
+        numLetters = length(letters)
+        for (i = 0; i < n; i++) {
+            len = 4 + int(rand() * 4) + int(rand() * 3) + int(rand() * 3)
+            word = ""
+            for (k = 0; k < len; k++) {
+                word = word substr(letters, 1 + int(rand() * numLetters), 1)
+            }
+            print word
+        }
+    }' | LC_ALL=C sort -u > "$2"
+}
+
+# solveWords input args...: the solved words, one per line
+solveWords() {
+    input=$1
+    shift
+    printf "%s\n" "$input" | "$EXE" -d "$dict" --format=csv "$@" 2>/dev/null | tail -n +2 | cut -d, -f1
+}
+
+# check name expected actual: report one comparison
+failed=0
+check() {
+    if [ "$2" = "$3" ]; then
+        printf "  ok    %s (%s words)\n" "$1" "$(printf "%s" "$2" | grep -c .)"
+    else
+        printf "  FAIL  %s\n" "$1"
+        failed=1
+    fi
+}
+
+dict="$DATA_DIR/synthetic_$SIZE.txt"
+if [ ! -f "$dict" ]; then
+    echo "generating $dict..."
+    generateDictionary "$SIZE" "$dict"
+fi
+
+for h in $HIVES; do
+    input=$(echo "$h" | tr '_' ' ')
+    expected=$(solveWords "$input")
+    for engine in $ENGINES; do
+        check "$input $engine" "$expected" "$(solveWords "$input" "$engine")"
+    done
+    for pair in $PAIRS; do
+        first=$(echo "$h" | cut -c"${pair%_*}")
+        second=$(echo "$h" | cut -c"${pair#*_}")
+        letters="$first$second"
+        included=$(printf "%s\n" "$expected" | grep "$first" | grep "$second")
+        check "$input -m --with $letters" "$included" "$(solveWords "$input" -m --with "$letters")"
+    done
+done
+
+if [ $failed -ne 0 ]; then
+    exit 1
+fi
+echo "  all engines agree with brute force"